@@ -0,0 +1,234 @@
+// batch.cpp implements the functions defined in the batch.h header file
+
+#include "batch.h"
+#include "piece_attacks.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	const std::size_t block_size = 1 << 22;		// The input is read 4 MB at a time, which is tens of thousands of positions
+	const std::size_t lines_per_task = 256;		// The number of lines a worker takes from the block at a time
+
+	// Function to find the end of the token starting at "start", tokens are separated by spaces and tabs
+	std::size_t token_end(std::string_view line, std::size_t start)
+	{
+		while (start < line.size() && line[start] != ' ' && line[start] != '\t') start++;
+		return start;
+	}
+
+	std::size_t skip_spaces(std::string_view line, std::size_t start)
+	{
+		while (start < line.size() && (line[start] == ' ' || line[start] == '\t')) start++;
+		return start;
+	}
+
+	// Function to check every line of a block, the workers take lines_per_task lines at a time until the block is done
+	void validate_block(const std::vector<std::string_view> &lines, std::vector<validation_result> &results, int number_of_threads)
+	{
+		std::atomic<std::size_t> next_line{ 0 };
+		auto worker = [&]() {
+			board chessboard;
+			for (;;) {
+				std::size_t first = next_line.fetch_add(lines_per_task);
+				if (first >= lines.size()) return;
+				std::size_t last = std::min(first + lines_per_task, lines.size());
+				for (std::size_t i = first; i < last; i++) results[i] = validate_line(lines[i], chessboard);
+			}
+		};
+		std::vector<std::thread> workers;
+		for (int i = 1; i < number_of_threads; i++) workers.emplace_back(worker);
+		worker(); //the calling thread works too
+		for (std::thread &t : workers) t.join();
+	}
+}
+
+// [1]  Function to name a status for the output
+
+const char *status_text(position_status status)
+{
+	switch (status) {
+	case status_normal:				return "ok";
+	case status_check:				return "check";
+	case status_checkmate:			return "checkmate";
+	case status_stalemate:			return "stalemate";
+	case status_bad_fen:			return "bad_fen";
+	case status_illegal_position:	return "illegal_position";
+	default:						return "illegal_move";
+	}
+}
+
+// [2]  Function to find what makes a position impossible to reach in a game, or nullptr if nothing does. These are the checks that can be made by looking
+//      at the position alone, a position that passes them could still be unreachable (for example, with pawns that could never have got where they are)
+
+const char *position_problem(const board &chessboard)
+{
+	const position &p = chessboard.get_position();
+	const bitboard back_rows = 0xff000000000000ffULL;
+	for (int team = 0; team < 2; team++) {
+		const bitboard *pieces = p.piece_sets[team];
+		if (count_squares(pieces[king_index]) != 1) return "each team must have exactly one king";
+		if (pieces[pawn_index] & back_rows) return "pawn on the first or last rank";
+		if (count_squares(pieces[pawn_index]) > 8) return "more than 8 pawns";
+		if (count_squares(p.team_occupancy[team]) > 16) return "more than 16 pieces";
+		//every piece above the starting number must have been a pawn that promoted
+		int promoted = std::max(0, count_squares(pieces[knight_index]) - 2) + std::max(0, count_squares(pieces[bishop_index]) - 2)
+			+ std::max(0, count_squares(pieces[rook_index]) - 2) + std::max(0, count_squares(pieces[queen_index]) - 1);
+		if (promoted > 8 - count_squares(pieces[pawn_index])) return "too many promoted pieces";
+	}
+
+	colour to_move = chessboard.team_to_move();
+	if (chessboard.checking_pieces(opposite_colour(to_move)) != 0) return "the team not to move is in check";
+	if (count_squares(chessboard.checking_pieces(to_move)) > 2) return "more than two pieces giving check";
+
+	//each castling right needs the king and the rook on their starting squares
+	std::uint8_t rights = chessboard.castling();
+	const bitboard *white_pieces = p.piece_sets[white]; const bitboard *black_pieces = p.piece_sets[black];
+	if ((rights & (white_king_side | white_queen_side)) && (white_pieces[king_index] & square_bit(60)) == 0) return "castling rights without the king on e1";
+	if ((rights & (black_king_side | black_queen_side)) && (black_pieces[king_index] & square_bit(4)) == 0) return "castling rights without the king on e8";
+	if ((rights & white_king_side) && (white_pieces[rook_index] & square_bit(63)) == 0) return "castling rights without the rook on h1";
+	if ((rights & white_queen_side) && (white_pieces[rook_index] & square_bit(56)) == 0) return "castling rights without the rook on a1";
+	if ((rights & black_king_side) && (black_pieces[rook_index] & square_bit(7)) == 0) return "castling rights without the rook on h8";
+	if ((rights & black_queen_side) && (black_pieces[rook_index] & square_bit(0)) == 0) return "castling rights without the rook on a8";
+	return nullptr;
+}
+
+// [3]  Function to check the position and moves of one line of input. The FEN is the first four fields and up to two more that are numbers, the rest of the
+//      line is moves. Each move must be one of the legal moves of the position it is played from
+
+validation_result validate_line(std::string_view line, board &chessboard)
+{
+	validation_result result{ status_normal, nullptr, 0, chess_move(0, 0), packed_position{} };
+	std::size_t fen_end = skip_spaces(line, 0);
+	for (int field = 0; field < 6; field++) {
+		std::size_t start = skip_spaces(line, fen_end);
+		if (start >= line.size()) break;
+		std::size_t end = token_end(line, start);
+		if (field >= 4 && std::all_of(line.begin() + start, line.begin() + end, [](char c) { return c >= '0' && c <= '9'; }) == false) break;
+		fen_end = end;
+	}
+	if (chessboard.from_fen(line.substr(0, fen_end)) == false) { result.status = status_bad_fen; return result; }
+	if ((result.reason = position_problem(chessboard)) != nullptr) { result.status = status_illegal_position; return result; }
+
+	move_list moves;
+	int move_number = 0;
+	for (std::size_t start = skip_spaces(line, fen_end); start < line.size(); start = skip_spaces(line, token_end(line, start))) {
+		move_number++;
+		chess_move m(0, 0);
+		bool legal = parse_move_text(line.substr(start, token_end(line, start) - start), m);
+		if (legal == true) {
+			chessboard.generate_legal_moves(chessboard.team_to_move(), moves);
+			legal = std::find(moves.begin(), moves.end(), m) != moves.end();
+		}
+		if (legal == false) {
+			result.status = status_illegal_move; result.move_number = move_number; result.illegal_move = m;
+			result.reason = "not a legal move";
+			return result;
+		}
+		chessboard.make_move(m);
+	}
+
+	bool in_check = chessboard.checking_pieces(chessboard.team_to_move()) != 0;
+	if (chessboard.has_legal_move(chessboard.team_to_move()) == false) result.status = in_check ? status_checkmate : status_stalemate;
+	else result.status = in_check ? status_check : status_normal;
+	result.packed = pack_position(chessboard);
+	return result;
+}
+
+// [4]  Function to check every line of the input, returns the number of lines that weren't legal positions. The input is read a block at a time into one
+//      buffer and split into lines in place, so no line is ever copied into a string of its own. A line cut off by the end of a block is moved to the front
+//      of the buffer and finished by the next block. The legal positions are stored in the order of the input. A summary with the speed goes to the error
+//      stream so it doesn't mix with the results
+
+unsigned long long run_batch_validation(std::istream &input, std::ostream &output, int number_of_threads, record_writer *store)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::vector<char> buffer(block_size);
+	std::vector<std::string_view> lines;
+	std::vector<unsigned long long> line_numbers;
+	std::vector<validation_result> results;
+	unsigned long long counts[status_illegal_move + 1] = {};
+	unsigned long long line_number = 0, total = 0;
+	std::size_t carried = 0; //the length of the unfinished line at the front of the buffer
+
+	for (bool finished = false; finished == false;) {
+		if (carried == buffer.size()) buffer.resize(buffer.size() * 2); //a single line longer than the buffer
+		input.read(buffer.data() + carried, std::streamsize(buffer.size() - carried));
+		std::size_t filled = carried + std::size_t(input.gcount());
+		finished = filled == carried;
+
+		lines.clear(); line_numbers.clear();
+		std::size_t line_start = 0;
+		for (std::size_t i = 0; i < filled; i++) {
+			if (buffer[i] != '\n' && (finished == false || i + 1 < filled)) continue;
+			std::size_t line_end = buffer[i] == '\n' ? i : i + 1;
+			line_number++;
+			std::string_view line(buffer.data() + line_start, line_end - line_start);
+			if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+			if (skip_spaces(line, 0) < line.size() && line[skip_spaces(line, 0)] != '#') { lines.push_back(line); line_numbers.push_back(line_number); } //blank lines and comments are skipped
+			line_start = i + 1;
+		}
+
+		results.resize(lines.size());
+		validate_block(lines, results, number_of_threads);
+		for (std::size_t i = 0; i < lines.size(); i++) {
+			const validation_result &r = results[i];
+			output << line_numbers[i] << ' ' << status_text(r.status);
+			if (r.status == status_illegal_move) output << ' ' << r.move_number << ' ' << move_text(r.illegal_move);
+			else if (r.reason != nullptr) output << ' ' << r.reason;
+			output << '\n';
+			if (store != nullptr && r.status <= status_stalemate) store->write_position(r.packed);
+			counts[r.status]++; total++;
+		}
+
+		carried = filled - std::min(line_start, filled); //move the unfinished line to the front of the buffer
+		std::copy(buffer.begin() + (filled - carried), buffer.begin() + filled, buffer.begin());
+	}
+	output.flush();
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cerr << total << " positions in " << seconds << " s (" << (seconds > 0 ? total / seconds : 0) << " positions/s, " << number_of_threads << " threads)\n";
+	for (int status = status_normal; status <= status_illegal_move; status++) std::cerr << "  " << status_text(position_status(status)) << ": " << counts[status] << "\n";
+	return counts[status_bad_fen] + counts[status_illegal_position] + counts[status_illegal_move];
+}
+
+// [5]  Function to run the batch mode from the command line arguments that follow "--batch": an optional file to read (standard input if there is none or it
+//      is "-"), an optional "--threads N" (every core by default) and an optional "--store FILE" to write the legal positions to. Rejected positions are
+//      part of the results, so the exit code is only 1 if the input can't be read or the positions can't be stored
+
+int batch_main(int argc, char *argv[])
+{
+	const char *file_name = nullptr;
+	const char *store_name = nullptr;
+	int number_of_threads = int(std::thread::hardware_concurrency());
+	for (int i = 0; i < argc; i++) {
+		std::string argument = argv[i];
+		if (argument == "--threads" && i + 1 < argc) number_of_threads = std::atoi(argv[++i]);
+		else if (argument == "--store" && i + 1 < argc) store_name = argv[++i];
+		else if (argument != "-") file_name = argv[i];
+	}
+	if (number_of_threads < 1) number_of_threads = 1;
+
+	std::ios::sync_with_stdio(false);
+	record_writer store;
+	if (store_name != nullptr && store.open(store_name, position_records) == false) { std::cerr << "Can't create " << store_name << std::endl; return 1; }
+	record_writer *writer = store_name != nullptr ? &store : nullptr;
+	if (file_name == nullptr) run_batch_validation(std::cin, std::cout, number_of_threads, writer);
+	else {
+		std::ifstream file(file_name, std::ios::binary);
+		if (!file) { std::cerr << "Can't open " << file_name << std::endl; return 1; }
+		run_batch_validation(file, std::cout, number_of_threads, writer);
+	}
+	if (writer != nullptr) {
+		std::uint64_t stored = store.records();
+		if (store.close() == false) { std::cerr << "Can't write " << store_name << std::endl; return 1; }
+		std::cerr << stored << " positions stored in " << store_name << "\n";
+	}
+	return 0;
+}
@@ -0,0 +1,34 @@
+// batch.h declares the batch validation mode of the chess executable, which checks positions without playing a game. Each line of the input is a position
+// in Forsyth-Edwards Notation (FEN), optionally followed by moves in coordinate notation (e.g. "e2e4") to be played from it. For each line one line of
+// output gives the line number and the status of the position after the moves: whether the FEN could be read, whether the position is legal, whether
+// every move was legal and whether the team to move is in check, check mate or stale mate. The legal positions can also be written to a file of
+// packed positions (see storage.h). The lines are read in large blocks and the positions of each
+// block are checked by a pool of worker threads, each with its own board, and the results are written in the order of the input
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "board_and_players.h"
+#include "storage.h"
+#include <iosfwd>
+#include <string_view>
+
+enum position_status { status_normal, status_check, status_checkmate, status_stalemate, status_bad_fen, status_illegal_position, status_illegal_move };
+
+																																// VALIDATION_RESULT STRUCT
+struct validation_result {																										//--------------------------------------------------------------------------------------------------------
+	position_status status;		// The status of the position after the moves, or why the line was rejected
+	const char *reason;			// What makes the position illegal, or nullptr
+	int move_number;			// The number (from 1) of the first illegal move, or 0
+	chess_move illegal_move;	// The first illegal move
+	packed_position packed;		// The position after the moves, packed for storing (only set if the position is legal)
+};
+
+const char *status_text(position_status status);																				// [1]  Function to name a status for the output
+const char *position_problem(const board &chessboard);																			// [2]  Function to find what makes a position impossible to reach in a game, or nullptr if nothing does
+validation_result validate_line(std::string_view line, board &chessboard);														// [3]  Function to check the position and moves of one line of input
+unsigned long long run_batch_validation(std::istream &input, std::ostream &output, int number_of_threads, record_writer *store = nullptr);	// [4]  Function to check every line of the input, returns the number of lines
+																																//      that weren't legal positions, storing the legal positions if store isn't nullptr
+int batch_main(int argc, char *argv[]);																							// [5]  Function to run the batch mode from the command line arguments that follow "--batch"
+
+#endif
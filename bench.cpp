@@ -0,0 +1,190 @@
+// bench.cpp is a benchmark of the search. It searches a fixed set of positions to a fixed depth and prints the depth, score, nodes, speed and principal
+// variation of every iteration, then the totals. The node counts only change when the search itself changes, so they show whether a change to the
+// engine changed what it searches, and the nodes per second track the speed of the engine from one version to the next
+//
+// Usage:	bench							search every position to the default depth
+//			bench <depth> [hash MB]			search every position to <depth> with a transposition table of [hash MB] megabytes (0 searches without a table)
+//			bench smp <depth> [threads] [hash MB]	search every position to <depth> with one thread and then with [threads] threads (all cores by default),
+//											printing the nodes of each thread and the speedup in time to reach the depth
+//			bench nnue [weights file]		measure the evaluations per second of the neural network (with random weights if no file is given) both
+//											refreshed from every piece and updated move by move, and of the hand written evaluation, and check that
+//											the updated accumulators match a full refresh in every position (the exit code is 1 if any don't)
+
+#include "piece_attacks.h"
+#include "search.h"
+#include "zobrist.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	// A position of the benchmark, given as the moves played from the start position
+	struct bench_position {
+		const char *name;
+		chess_move moves[8];
+		int number_of_moves;
+	};
+
+	const bench_position bench_positions[] = {
+		{ "Start position", {}, 0 },
+		{ "Open game", { { 52, 36 }, { 12, 28 }, { 62, 45 }, { 1, 18 }, { 61, 34 } }, 5 },					// 1.e4 e5 2.Nf3 Nc6 3.Bb5
+		{ "Queen's gambit", { { 51, 35 }, { 11, 27 }, { 50, 34 }, { 27, 34 }, { 52, 36 }, { 12, 28 } }, 6 },	// 1.d4 d5 2.c4 dxc4 3.e4 e5
+	};
+
+	void print_iteration(const search_result &r)
+	{
+		std::cout << "  depth " << std::setw(2) << r.depth << "  score " << std::setw(6) << r.score << "  nodes " << std::setw(11) << r.nodes
+			<< "  " << std::fixed << std::setprecision(2) << std::setw(7) << r.nodes_per_second() / 1e6 << " Mnodes/s  pv";
+		for (int ply = 0; ply < r.pv_length; ply++) std::cout << " " << move_text(r.principal_variation[ply]);
+		std::cout << std::endl;
+	}
+
+	// Function to set up the board of a benchmark position and find the team to move
+	colour set_up_position(const bench_position &test, board &chessboard)
+	{
+		colour team_to_move = white;
+		for (int i = 0; i < test.number_of_moves; i++) { chessboard.make_move(test.moves[i]); team_to_move = opposite_colour(team_to_move); }
+		return team_to_move;
+	}
+
+	// Function to measure how a parallel search scales: each position is searched to the same depth with one thread and then with many, both from an
+	// empty table, and the speedup is the ratio of the times taken
+	int run_smp_bench(int depth, int number_of_threads, int hash_megabytes)
+	{
+		transposition_table table(hash_megabytes);
+		search_limits limits; limits.max_depth = depth;
+		double single_seconds = 0, parallel_seconds = 0; unsigned long long single_nodes = 0, parallel_nodes = 0;
+		for (const bench_position &test : bench_positions) {
+			board chessboard;
+			colour team_to_move = set_up_position(test, chessboard);
+			std::vector<unsigned long long> thread_nodes;
+
+			table.clear();
+			search_result single = parallel_search(chessboard, team_to_move, limits, table, 1, thread_nodes);
+			table.clear();
+			search_result parallel = parallel_search(chessboard, team_to_move, limits, table, number_of_threads, thread_nodes);
+			single_seconds += single.seconds; parallel_seconds += parallel.seconds;
+			single_nodes += single.nodes; parallel_nodes += parallel.nodes;
+
+			std::cout << test.name << std::fixed << std::setprecision(3) << "\n  1 thread   " << single.seconds << " s  " << std::setw(11) << single.nodes << " nodes  best "
+				<< move_text(single.best_move) << "\n  " << number_of_threads << " threads  " << parallel.seconds << " s  " << std::setw(11) << parallel.nodes
+				<< " nodes  best " << move_text(parallel.best_move) << "  speedup " << std::setprecision(2) << (parallel.seconds > 0 ? single.seconds / parallel.seconds : 0)
+				<< "\n  nodes per thread:";
+			for (unsigned long long nodes : thread_nodes) std::cout << " " << nodes;
+			std::cout << std::endl;
+		}
+		std::cout << std::fixed << std::setprecision(2) << "\nTime to depth " << depth << " speedup " << (parallel_seconds > 0 ? single_seconds / parallel_seconds : 0)
+			<< "   1 thread " << (single_seconds > 0 ? single_nodes / single_seconds / 1e6 : 0) << " Mnodes/s   " << number_of_threads << " threads "
+			<< (parallel_seconds > 0 ? parallel_nodes / parallel_seconds / 1e6 : 0) << " Mnodes/s" << std::endl;
+		return 0;
+	}
+
+	// Function to measure the speed of the neural network and check its incremental updates. A set of random games is played from the start position,
+	// keeping every position, the undo record of the move that reached it and the board. Every accumulator updated from the one before it is compared with
+	// one refreshed from every piece, then each way of evaluating is timed over all of the positions
+	int run_nnue_bench(const char *file_name)
+	{
+		nnue_network network;
+		if (file_name != nullptr && network.load(file_name) == false) { std::cerr << "Can't read the weights file " << file_name << std::endl; return 1; }
+		if (file_name == nullptr) network.randomise(1);
+		std::cout << "Network " << (file_name != nullptr ? file_name : "with random weights") << ", " << nnue_inputs << " inputs, " << nnue_hidden << " x 2 hidden, " << nnue_second_layer << " in the second layer" << std::endl;
+
+		const int number_of_games = 200, max_plies = 150;
+		std::vector<board> boards; std::vector<move_undo> undos; std::vector<int> game_starts;
+		std::uint64_t seed = 2024;
+		unsigned long long mismatches = 0;
+		nnue_accumulator updated, refreshed;
+		for (int game = 0; game < number_of_games; game++) {
+			board chessboard;
+			game_starts.push_back(int(boards.size()));
+			boards.push_back(chessboard); undos.push_back(move_undo{});
+			network.refresh(chessboard.get_position(), updated);
+			for (int ply = 0; ply < max_plies && chessboard.draw_by_rule() == false; ply++) {
+				move_list moves;
+				chessboard.generate_legal_moves(chessboard.team_to_move(), moves);
+				if (moves.size() == 0) break;
+				move_undo undo = chessboard.make_move(moves[int(next_random(seed) % std::uint64_t(moves.size()))]);
+				nnue_accumulator before = updated;
+				network.update(before, updated, undo, chessboard.get_position());
+				network.refresh(chessboard.get_position(), refreshed);
+				if (std::memcmp(&updated, &refreshed, sizeof(updated)) != 0
+					|| network.evaluate(updated, chessboard.team_to_move()) != network.evaluate(refreshed, chessboard.team_to_move())) mismatches++;
+				boards.push_back(chessboard); undos.push_back(undo);
+			}
+		}
+		game_starts.push_back(int(boards.size()));
+		std::cout << boards.size() << " positions from " << number_of_games << " random games, " << mismatches << " incremental updates differ from a full refresh" << std::endl;
+
+		const int repeats = 20;
+		long long checksum = 0; //adding up the scores stops the compiler leaving out evaluations whose results aren't used
+		auto time_evaluations = [&](const char *name, auto &&evaluate_all) {
+			auto start = std::chrono::steady_clock::now();
+			for (int repeat = 0; repeat < repeats; repeat++) evaluate_all();
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			double evaluations = double(boards.size()) * repeats;
+			std::cout << "  " << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(2) << std::setw(8) << evaluations / seconds / 1e6
+				<< " Mevals/s  " << std::setprecision(1) << std::setw(6) << seconds * 1e9 / evaluations << " ns/eval" << std::endl;
+		};
+		time_evaluations("network, full refresh", [&]() {
+			for (const board &chessboard : boards) {
+				network.refresh(chessboard.get_position(), refreshed);
+				checksum += network.evaluate(refreshed, chessboard.team_to_move());
+			}
+		});
+		time_evaluations("network, incremental", [&]() {
+			for (int game = 0; game < number_of_games; game++) {
+				network.refresh(boards[game_starts[game]].get_position(), updated);
+				for (int i = game_starts[game] + 1; i < game_starts[game + 1]; i++) {
+					nnue_accumulator before = updated;
+					network.update(before, updated, undos[i], boards[i].get_position());
+					checksum += network.evaluate(updated, boards[i].team_to_move());
+				}
+			}
+		});
+		time_evaluations("hand written evaluation", [&]() {
+			for (const board &chessboard : boards) checksum += evaluate(chessboard, chessboard.team_to_move());
+		});
+		std::cout << "  (checksum " << checksum << ")" << std::endl;
+		return mismatches == 0 ? 0 : 1;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc > 1 && std::string(argv[1]) == "nnue") return run_nnue_bench(argc > 2 ? argv[2] : nullptr);
+	if (argc > 1 && std::string(argv[1]) == "smp") {
+		int depth = argc > 2 ? std::atoi(argv[2]) : 8;
+		int number_of_threads = argc > 3 ? std::atoi(argv[3]) : int(std::thread::hardware_concurrency());
+		int hash_megabytes = argc > 4 ? std::atoi(argv[4]) : 64;
+		if (depth < 1 || number_of_threads < 1 || hash_megabytes < 1) { std::cerr << "Usage: bench smp [depth [threads [hash MB]]]" << std::endl; return 1; }
+		return run_smp_bench(depth, number_of_threads, hash_megabytes);
+	}
+
+	int depth = argc > 1 ? std::atoi(argv[1]) : 6;
+	int hash_megabytes = argc > 2 ? std::atoi(argv[2]) : 16;
+	if (depth < 1 || hash_megabytes < 0) { std::cerr << "Usage: bench [depth [hash MB]]" << std::endl; return 1; }
+	transposition_table table(hash_megabytes > 0 ? hash_megabytes : 1);
+
+	unsigned long long total_nodes = 0; double total_seconds = 0;
+	for (const bench_position &test : bench_positions) {
+		std::cout << test.name << std::endl;
+		board chessboard;
+		colour team_to_move = set_up_position(test, chessboard);
+
+		table.clear(); //each position starts from an empty table so the node counts don't depend on the positions before it
+		table.new_search();
+		search_engine engine(hash_megabytes > 0 ? &table : nullptr);
+		search_limits limits; limits.max_depth = depth;
+		search_result result = engine.find_best_move(chessboard, team_to_move, limits, print_iteration);
+		std::cout << "  best move " << move_text(result.best_move) << std::endl;
+		total_nodes += result.nodes; total_seconds += result.seconds;
+	}
+	std::cout << "\nTotal " << total_nodes << " nodes   " << std::fixed << std::setprecision(3) << total_seconds << " s   "
+		<< std::setprecision(2) << (total_seconds > 0 ? total_nodes / total_seconds / 1e6 : 0) << " Mnodes/s" << std::endl;
+	return 0;
+}
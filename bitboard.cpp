@@ -0,0 +1,42 @@
+// bitboard.cpp implements the functions defined in the bitboard.h header file
+
+#include "bitboard.h"
+
+// BITBOARD FUNCTIONS
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// [12] Function to convert the piece_type enum into the index of its piece set (the enum values are the piece values, so they can't be used as an index directly)
+
+piece_index to_piece_index(piece_type type_of_piece)
+{
+	switch (type_of_piece)
+	{
+	case pawn:		return pawn_index;
+	case knight:	return knight_index;
+	case bishop:	return bishop_index;
+	case rook:		return rook_index;
+	case queen:		return queen_index;
+	default:		return king_index;
+	}
+}
+
+// [13] Function to convert the index of a piece set back into the piece_type enum
+
+piece_type to_piece_type(int index_of_piece)
+{
+	static const piece_type types[number_of_piece_types] = { pawn, knight, bishop, rook, queen, king };
+	return types[index_of_piece];
+}
+
+
+// POSITION STRUCT
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// [14] Function to empty the position of all pieces
+
+void position::clear()
+{
+	for (int team = 0; team < 2; team++) {
+		for (int type = 0; type < number_of_piece_types; type++) piece_sets[team][type] = 0;
+		team_occupancy[team] = 0;
+	}
+	for (int index = 0; index < 64; index++) piece_codes[index] = empty_square;
+}
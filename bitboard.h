@@ -0,0 +1,99 @@
+// bitboard.h declares the bitboard representation of the chess pieces used by the board class. A bitboard is a 64 bit integer with one bit for each square
+// of the board, the bit index of a square is row * 8 + column so that bit 0 is the top left square of the console board (row 0, column 0) and bit 63 is the
+// bottom right square. The position struct stores one bitboard for each of the twelve piece sets (six piece types for each team colour) plus a bitboard
+// of the squares occupied by each team and a one byte code for the piece on each square, so the whole state of the board is a small fixed size block of memory
+// which can be copied like an int
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "board_components.h"
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+typedef std::uint64_t bitboard;																									// A set of squares, one bit per square of the board
+
+enum piece_index { pawn_index = 0, knight_index = 1, bishop_index = 2, rook_index = 3, queen_index = 4, king_index = 5 };		// Index of each piece type in the piece sets of a position
+const int number_of_piece_types = 6;
+
+typedef std::uint8_t piece_code;																								// A piece stored in one byte, bit 3 is the colour and bits 0-2 are the piece_index plus one
+const piece_code empty_square = 0;																								// The code of a square with no piece on it
+
+enum castling_right { white_king_side = 1, white_queen_side = 2, black_king_side = 4, black_queen_side = 8 };					// One bit for each way of castling that is still allowed
+const std::uint8_t all_castling_rights = 15;
+const std::int8_t no_en_passant = -1;																							// The en passant column when the last move wasn't a two square pawn push
+
+inline int square_index(int row, int column) { return row * 8 + column; }														// [1]  Function to convert a row and column of the board into a bit index
+inline int index_row(int index) { return index >> 3; }																			// [2]  Function to retrieve the row of a bit index
+inline int index_column(int index) { return index & 7; }																		// [3]  Function to retrieve the column of a bit index
+inline bitboard square_bit(int index) { return bitboard(1) << index; }															// [4]  Function to make a bitboard containing only the square at a bit index
+
+inline int lowest_square(bitboard b) {																							// [5]  Function to find the bit index of the lowest square in a non-empty bitboard
+#if defined(_MSC_VER)
+	unsigned long index; _BitScanForward64(&index, b); return int(index);
+#else
+	return __builtin_ctzll(b);
+#endif
+}
+
+inline int pop_lowest_square(bitboard &b) { int index = lowest_square(b); b &= b - 1; return index; }							// [6]  Function to remove the lowest square from a non-empty bitboard and return its bit index
+
+inline int count_squares(bitboard b) {																							// [7]  Function to count the number of squares in a bitboard
+#if defined(_MSC_VER)
+	return int(__popcnt64(b));
+#else
+	return __builtin_popcountll(b);
+#endif
+}
+
+inline piece_code make_piece_code(colour piece_colour, piece_index type_index) { return piece_code((piece_colour << 3) | (type_index + 1)); }	// [8]  Function to pack a team colour and piece type into a piece code
+inline colour code_colour(piece_code code) { return colour(code >> 3); }														// [9]  Function to unpack the team colour of a piece code
+inline piece_index code_type(piece_code code) { return piece_index((code & 7) - 1); }											// [10] Function to unpack the piece type of a piece code
+
+inline std::uint8_t castling_rights_kept(int index) {																			// [11] Function to find the castling rights which survive a move from or to a square, moving a king or rook
+	switch (index) {																											//      (or taking a rook) from its starting square loses the rights that depend on it
+	case 0:		return all_castling_rights & ~black_queen_side;
+	case 4:		return all_castling_rights & ~(black_king_side | black_queen_side);
+	case 7:		return all_castling_rights & ~black_king_side;
+	case 56:	return all_castling_rights & ~white_queen_side;
+	case 60:	return all_castling_rights & ~(white_king_side | white_queen_side);
+	case 63:	return all_castling_rights & ~white_king_side;
+	default:	return all_castling_rights;
+	}
+}
+
+piece_index to_piece_index(piece_type type_of_piece);																			// [12] Function to convert the piece_type enum into the index of its piece set
+piece_type to_piece_type(int index_of_piece);																					// [13] Function to convert the index of a piece set back into the piece_type enum
+
+																																// POSITION STRUCT
+struct position {																												//--------------------------------------------------------------------------------------------------------
+	bitboard piece_sets[2][number_of_piece_types];	// One bitboard for each piece type of each team, indexed by [colour][piece_index]
+	bitboard team_occupancy[2];						// The squares occupied by each team, indexed by [colour]
+	piece_code piece_codes[64];						// The piece on each square as a single byte, so the piece on a square is found without searching the piece sets
+
+	void clear();																												// [14] Function to empty the position of all pieces
+
+	void add_piece(colour piece_colour, piece_index type_index, int index) {													// [15] Function to put a piece on an empty square
+		piece_sets[piece_colour][type_index] |= square_bit(index);
+		team_occupancy[piece_colour] |= square_bit(index);
+		piece_codes[index] = make_piece_code(piece_colour, type_index);
+	}
+	void remove_piece(colour piece_colour, piece_index type_index, int index) {													// [16] Function to take a piece off a square
+		piece_sets[piece_colour][type_index] &= ~square_bit(index);
+		team_occupancy[piece_colour] &= ~square_bit(index);
+		piece_codes[index] = empty_square;
+	}
+	bool find_piece(int index, colour &piece_colour, piece_index &type_index) const {											// [17] Function to identify the piece occupying a square, returns false if the square is empty
+		piece_code code = piece_codes[index];
+		if (code == empty_square) return false;
+		piece_colour = code_colour(code); type_index = code_type(code);
+		return true;
+	}
+
+	bitboard occupancy() const { return team_occupancy[white] | team_occupancy[black]; }										// [18] Function to retrieve every occupied square
+	bool is_occupied(int index) const { return piece_codes[index] != empty_square; }											// [19] Function to check if a square contains a piece
+};
+
+#endif
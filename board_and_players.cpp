@@ -4,25 +4,70 @@
 
 #include "board_and_players.h"
 #include "board_components.h"
+#include "evaluation.h"
+#include "piece_attacks.h"
+#include "zobrist.h"
+#include <algorithm>
 #include <iostream>
 #include <string>
-#include <vector>
+
+namespace {
+	// Function to add the moves of every piece in a piece set, the piece type is a template parameter so each call is compiled with its own attack lookup
+	template<piece_index type> void add_piece_moves(bitboard pieces, bitboard occupied, bitboard targets, move_list &moves)
+	{
+		while (pieces) {
+			int from = pop_lowest_square(pieces);
+			bitboard to_squares = attacks<type>(from, occupied) & targets;
+			while (to_squares) moves.add(from, pop_lowest_square(to_squares));
+		}
+	}
+
+	// Function to add the pawn moves ending on a set of squares, each one started "step" squares back. A pawn reaching the last row becomes a queen, rook,
+	// bishop or knight so it makes four moves, the queen first since it is almost always the best
+	void add_pawn_moves(bitboard to_squares, int step, move_list &moves)
+	{
+		const bitboard last_rows = 0xff000000000000ffULL;
+		bitboard promotions = to_squares & last_rows;
+		to_squares &= ~last_rows;
+		while (to_squares) { int to = pop_lowest_square(to_squares); moves.add(to - step, to); }
+		while (promotions) {
+			int to = pop_lowest_square(promotions);
+			for (int type = queen_index; type >= knight_index; type--) moves.add(to - step, to, type);
+		}
+	}
+
+	// Function to check if a team can castle on one side. The king and rook must still have the right to castle, the squares between them must be empty
+	// and the king must not be in check or pass over or land on a square the enemy attacks
+	bool castling_allowed(const position &p, bitboard enemy_attacks, std::uint8_t rights, colour team, bool king_side)
+	{
+		int king = team == white ? 60 : 4;
+		std::uint8_t right = team == white ? (king_side ? white_king_side : white_queen_side) : (king_side ? black_king_side : black_queen_side);
+		if ((rights & right) == 0) return false;
+		int rook = king_side ? king + 3 : king - 4;
+		if ((p.piece_sets[team][king_index] & square_bit(king)) == 0 || (p.piece_sets[team][rook_index] & square_bit(rook)) == 0) return false;
+		bitboard king_path = king_side ? square_bit(king) | square_bit(king + 1) | square_bit(king + 2) : square_bit(king) | square_bit(king - 1) | square_bit(king - 2);
+		return (between(king, rook) & p.occupancy()) == 0 && (king_path & enemy_attacks) == 0;
+	}
+
+	// Function to find the square of the pawn taken by a pawn moving diagonally onto an empty square, it is beside the start square
+	int en_passant_square(int from, int to) { return square_index(index_row(from), index_column(to)); }
+}
 
 
 // BOARD CLASS
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 // [1]  Overload the "<<" operator of the output stream for the board class so that it can be represented easily on the console
 
-std::ostream & operator<<(std::ostream &os, board &b) {
+std::ostream & operator<<(std::ostream &os, const board &b) {
 	os << std::endl << "         .1    .2    .3    .4    .5    .6    .7    .8 " << std::endl;	// index the columns of the board squares on the console
 	os << "        _____ _____ _____ _____ _____ _____ _____ _____ " << std::endl;
-	for (int row = 0; row <8; row++) {		// Loop over the 8 row elements of 2D array of board squares 
+	for (int row = 0; row <8; row++) {		// Loop over the 8 rows of the board
 		os << "       |     |     |     |     |     |     |     |     |" << std::endl;
 		os << "  ." << row + 1 << "   |";		   // index the rows of the board squares on the console
 		for (int column = 0; column < 8; column++) {		// Now looping over the columns
-			if (b.game_board[row][column].is_occupied() == true) { // Access each square in the board with "b.game_board[row][column]", use member function ".is_occupied()" to check if it contains a piece
-				os << "  " << *b.game_pieces[b.game_board[row][column]] << "  |"; // If square contains a piece, locate piece in the map of pieces with the corresponding square key and output it on the board
-				// "b.game_board[row][column]" is a square, since a piece occupies it, it is also a key to a piece pointer in our map, so we access the piece by derefencing the pointer that we get from b.game_pieces[b.game_board[row][column]]
+			colour piece_colour = white; piece_type type_of_piece = pawn;
+			if (b.piece_on_square(square_index(row, column), piece_colour, type_of_piece) == true) { // Look up the square in the bitboards of the position to check if it contains a piece
+				os << "  " << piece(b.access_board_square(row, column), piece_colour, type_of_piece) << "  |"; // If square contains a piece, output a piece of the same type and colour on the board
 			}
 			else { //else the square is empty so we do not output a piece, instead just output an extra " " character
 				os << "     |";
@@ -33,421 +78,646 @@ std::ostream & operator<<(std::ostream &os, board &b) {
 	return os;
 }
 
-// [2]  Overload the "<" operator for comparing squares so that they can be used as a key for our map of pieces 
+// [2]  Function to identify the piece and team occupying a square of the position, returns false if the square is empty
 
-bool operator<(const square& lhs, const square& rhs) { //Set squares to be compared primarily by their row and secondarily by their column
-	return(lhs.get_row() + (0.1*lhs.get_column())) < (rhs.get_row() + (0.1*rhs.get_column()));
+bool board::piece_on_square(int index, colour &piece_colour, piece_type &type_of_piece) const {
+	piece_index type_index;
+	if (game_position.find_piece(index, piece_colour, type_index) == false) return false;
+	type_of_piece = to_piece_type(type_index);
+	return true;
 }
 
-// [3] A Function to look at our map of pieces, by outputing the key (square the piece is in) and the piece contained in the map belonging to that square (good for checking if the structure is storing things correctly)
+// [3]  Function to work out the attack maps, checking pieces and pinned pieces of both teams from the position. This is called whenever the position
+//      changes so that the questions "is the king attacked", "which pieces give check" and "which pieces are pinned" are answered by reading a bitboard.
+//      After a move, changed holds the squares whose pieces changed (the move's start and end squares, the square of a taken piece and a castling rook's
+//      squares) and only what those squares can have changed is worked out again; by default everything is. An attack map is a union over many pieces,
+//      so a piece's attacks can't simply be taken out of it, and the team that moved has its map worked out in full. The other team's pieces stayed where
+//      they were, so unless one of them was taken its map only changes if one of its sliders' lines was opened or blocked, which means the line reached
+//      a changed square and the map from before the move holds that square. The pieces giving check to the team that moved can only change if the other
+//      team's map does or the king moved. The pins are always worked out again: they only change when a changed square lies on a line out from the king,
+//      but testing that (and mispredicting the branch) took as long as finding the pins, so skipping them made moves no faster
+
+void board::refresh_attack_maps(bitboard changed, bool taking) {
+	colour moving_colour = opposite_colour(side_to_move), enemy_colour = side_to_move;
+	bool enemy_changed = taking == true || (attack_maps[enemy_colour] & changed) != 0;
+	attack_maps[moving_colour] = team_attacks(game_position, moving_colour);
+	if (enemy_changed == true) attack_maps[enemy_colour] = team_attacks(game_position, enemy_colour);
+	bitboard occupied = game_position.occupancy();
+	for (int team = 0; team < 2; team++) {
+		bitboard king_set = game_position.piece_sets[team][king_index];
+		if (king_set == 0) { check_pieces[team] = 0; pinned[team] = 0; continue; }
+		int king = lowest_square(king_set);
+		bool king_moved = (king_set & changed) != 0;
+		if (team == enemy_colour || enemy_changed == true || king_moved == true) {
+			check_pieces[team] = attackers_to(game_position, king, opposite_colour(colour(team)), occupied);
+		}
+		pinned[team] = ::pinned_pieces(game_position, colour(team));
+	}
+}
+
+// [4] A Function to look at the pieces on the board, by outputing the square each piece is in and the piece contained in that square (good for checking if the structure is storing things correctly)
 
 void board::look_at_map() {
-	for (auto const& x : game_pieces) //iterate over the map
+	bitboard occupied = game_position.occupancy();
+	while (occupied) //iterate over the occupied squares, lowest bit index first
 	{
-		std::cout << "\nELEMENT KEY " << x.first << "\nPIECE CONTAINED: " << *x.second << std::endl; //output the key (square) followed by the dereferenced piece* that is contained in that element
+		int index = pop_lowest_square(occupied);
+		colour piece_colour = white; piece_type type_of_piece = pawn;
+		piece_on_square(index, piece_colour, type_of_piece);
+		square piece_square = access_board_square(index_row(index), index_column(index));
+		std::cout << "\nELEMENT KEY " << piece_square << "\nPIECE CONTAINED: " << piece(piece_square, piece_colour, type_of_piece) << std::endl; //output the square followed by the piece that is contained in it
 	}
 }
 
-// [4]  Unparameterised board constructor
+// [5]  Unparameterised board constructor, the board is set up with the starting position of a game
 
 board::board() {
-	game_board = new square*[8]; // think of this as the y-coordinates of the chess board, the rows
-	for (int row = 0; row < 8; row++) {
-		game_board[row] = new square[8]; //for each y-coordinate allocate 8 x-coordinates of squares to form our 8x8 board of squares
-	}
-	//A 2D array of 64 squares has been assigned to memory, now set it up as a chess board
-	for (int row = 0; row < 8; row++) { //loop over all elements
-		for (int column = 0; column < 8; column++) {
-			if (row == 0 || row == 1 || row == 6 || row == 7) { // The front two and back two rows of squares on a chess board are filled with pieces
-				game_board[row][column] = square(row, column, true); //make sure the squares in these rows reflect this ("true" indicates a piece occupies this square)
-			}
-			else {	//else the other squares are initially empty, "false" parameter in "square(row, column, false)" indicates this
-				game_board[row][column] = square(row, column, false);
-			}
-		}
-	}
-	// Our board array of squares has been set up, now map our pieces onto the board by assigning a chess piece to the squares that contain pieces
-	for (int row = 0; row < 8; row++) {
-		bool entered_once = false; bool* ptr = &entered_once;
-		for (int column = 0; column < 8; column++) {
-			if (row == 0 && entered_once == false) { //Create map elements with square keys that initially contain pieces on a chess board. Fill each element with the correct piece for an initially setup chessboard
-				game_pieces[game_board[row][0]] = new Rook(game_board[row][0], black);    // Chess pieces contained in squares on back row aren't all the same type, initialise all separately once for black pieces
-				game_pieces[game_board[row][1]] = new Knight(game_board[row][1], black);
-				game_pieces[game_board[row][2]] = new Bishop(game_board[row][2], black);
-				game_pieces[game_board[row][3]] = new Queen(game_board[row][3], black);
-				game_pieces[game_board[row][4]] = new King(game_board[row][4], black);
-				game_pieces[game_board[row][5]] = new Bishop(game_board[row][5], black);
-				game_pieces[game_board[row][6]] = new Knight(game_board[row][6], black);
-				game_pieces[game_board[row][7]] = new Rook(game_board[row][7], black);
-				*ptr = true; //indicate that this row has been set up so no need to redo it
-			}
-			else if (row == 1) { // Assign black pawns to all the square keys for this row of squares in our map 
-				game_pieces[game_board[row][column]] = new Pawn(game_board[row][column], black);
-			}
-			else if (row == 6) {
-				game_pieces[game_board[row][column]] = new Pawn(game_board[row][column], white); // Now assign the white pawns a key
-			}
-			else if (row == 7 && entered_once == false) { //And the rest of the white team pieces there initial keys
-				game_pieces[game_board[row][0]] = new Rook(game_board[row][0], white);
-				game_pieces[game_board[row][1]] = new Knight(game_board[row][1], white);
-				game_pieces[game_board[row][2]] = new Bishop(game_board[row][2], white);
-				game_pieces[game_board[row][3]] = new Queen(game_board[row][3], white);
-				game_pieces[game_board[row][4]] = new King(game_board[row][4], white);
-				game_pieces[game_board[row][5]] = new Bishop(game_board[row][5], white);
-				game_pieces[game_board[row][6]] = new Knight(game_board[row][6], white);
-				game_pieces[game_board[row][7]] = new Rook(game_board[row][7], white);
-				*ptr = true;
-			}
-		}
-	}
+	from_fen(start_fen);
 	//BOARD HAS NOW BEEN INITIALISED 
 }
 
-// [5]  Board destructor
-
-board::~board() {	// Delete all memory assigned to the 2D array of squares and the map of pieces in the destructor
-	for (int row = 0; row < 8; row++) delete[] game_board[row];
-	delete[] game_board; game_pieces.clear();
-}
+// [8]  A Function to allow access to one of the squares of the board, the square is built from the position so it knows whether it contains a piece
 
-// [6]  Operator overloaded for "=" for board object
+square board::access_board_square(int row, int column) const { return square(row, column, game_position.is_occupied(square_index(row, column))); }
 
-board & board:: operator=(board &b) {
-	if (&b == this) return *this; //if our assignments are already the same object, the object remains as it was
-	//else
-	// First delete this object's array
+// [9]  Function to put a new piece onto an empty square of the board, setting the bit of the square in the piece set and the team occupancy
 
-	game_pieces = b.game_pieces;
-	for (int row = 0; row < 8; row++) { //loop over all elements
-		for (int column = 0; column < 8; column++) {
-			game_board[row][column] = b.game_board[row][column]; //make sure the squares in these rows reflect this ("true" indicates a piece occupies this square)
-		}
-	}
-
-	return *this; // Special pointer!!!
+void board::add_piece(const square &new_square, colour piece_colour, piece_type type_of_piece) {
+	int index = square_index(new_square.get_row(), new_square.get_column());
+	game_position.add_piece(piece_colour, to_piece_index(type_of_piece), index);
+	zobrist_key ^= piece_key(piece_colour, to_piece_index(type_of_piece), index);
+	piece_scores.add_piece(piece_colour, to_piece_index(type_of_piece), index);
+	refresh_attack_maps();
+	//Checks are made outside of this function so that the square argument in this function is defintiely empty
 }
 
-// [7]  A Function to allow access to one of the 2D "game_board" squares, since the array is privately stored this is necessary for other objects to be able to access the private game_board 
-
-square board::access_board_square(int row, int column) const { return game_board[row][column]; }
-
-// [8]  Function to add a new element to our map, which is needed when a new square (i.e. key) contains a piece. Therefore this is necessary to update our map whenever a piece is moved
+// [10] Function to update the chess board with a move	
 
-void board::add_Map_element(square &new_key, piece* &piece_to_contain) {
-	game_pieces[new_key] = piece_to_contain;  //When you write game_pieces[new_key], and that element doesn't exist, it is created and constructed to contain the piece
-	//Checks are made outside of this function so that the square argument in this function is defintiely a valid new key for our map
+void board::update_board(const square &piece_start, const square &piece_end) {
+	//the move is made in place on the position, the undo record isn't needed since this move is kept
+	make_move(chess_move(square_index(piece_start.get_row(), piece_start.get_column()), square_index(piece_end.get_row(), piece_end.get_column())));
 }
 
-// [9] Function to update the chess board with a move	
+// [11] Function to check if a move is valid for the board, check various things like squares being on the board, squares containing pieces and certain piece movement paths being valid 
 
-void board::update_board(square &piece_start, square &piece_end) {
-	//update the position of the piece in the piece class before deep copying the piece into the map of pieces using the "piece_end" square key 
-	bool t = true;
-	bool f = false;
-	if (game_board[piece_end.get_row()][piece_end.get_column()].is_occupied() == true) { //if the move is taking a piece, we will lose an element of our map structure
-		game_pieces[game_board[piece_start.get_row()][piece_start.get_column()]]->update_position(game_board[piece_end.get_row()][piece_end.get_column()]);
-		game_pieces[game_board[piece_end.get_row()][piece_end.get_column()]] = game_pieces[game_board[piece_start.get_row()][piece_start.get_column()]];
-		game_pieces.erase(game_board[piece_start.get_row()][piece_start.get_column()]); //erase the element belonging to the old key in the map
-		(game_board[piece_start.get_row()][piece_start.get_column()]).now_contains_piece(f);
-	}
-	else { //if we are not taking a piece the square we are trying to move to is not currently a key in our map of structures, therefore we need to add a new element and delete the old one
-		game_board[piece_end.get_row()][piece_end.get_column()].now_contains_piece(t);
-		//piece_end.now_contains_piece(true);
-		add_Map_element(game_board[piece_end.get_row()][piece_end.get_column()], game_pieces[game_board[piece_start.get_row()][piece_start.get_column()]]);
-
-		game_board[piece_start.get_row()][piece_start.get_column()].now_contains_piece(f);
-		//piece_start.now_contains_piece(false);
-		game_pieces.erase(game_board[piece_start.get_row()][piece_start.get_column()]); //erase the element belonging to the old key in the map
-	}
-}
-
-// [10] Function to check if a move is valid for the board, check various things like squares being on the board, squares containing pieces and certain piece movement paths being valid 
-
-bool board::valid_board_move(colour team_colour, square &start_position, square &new_position){
+bool board::valid_board_move(colour team_colour, const square &start_position, const square &new_position){
+	int start_index = square_index(start_position.get_row(), start_position.get_column());
+	int end_index = square_index(new_position.get_row(), new_position.get_column());
+	colour start_colour, end_colour; piece_index piece_moving, piece_taken;
 	// Check that a piece to be moved actually occupies in the start_position square, and check that it belongs to the players team colour
-	if (start_position.is_occupied() == false || game_pieces[start_position]->get_colour() != team_colour) {
+	if (game_position.find_piece(start_index, start_colour, piece_moving) == false || start_colour != team_colour) {
 		return false; //if start position is unoccupied return false
 	}
 	//Now check if the position the piece is being moved to is already occupied by a piece that the player owns
-	else if (new_position.is_occupied() == true && game_pieces[new_position]->get_colour() == team_colour) {
+	bool end_occupied = game_position.find_piece(end_index, end_colour, piece_taken);
+	if (end_occupied == true && end_colour == team_colour) {
 		return false; //if it is already occupied by a piece you own the move is not valid so return false		
 	}
 	//Now check if the movement is valid for the piece, if it isn't then return false
-	else if (game_pieces[start_position]->valid_piece_movement(start_position, new_position) == false) {
-		return false;
-	}
-	else { // the piece move is valid for the piece, but is it valid for the board?
-		//for certain pieces, the bishop, the rook, the queen and the pawn when it moves two spaces, the paths to their destination need to be clear for the move to be possible
-		//for these pieces check that the path is clear for their moves to be valid
-		piece_type piece_moving = game_pieces[start_position]->get_identity();
-		if (piece_moving == queen || piece_moving == rook || piece_moving == bishop){
-			int start_row = start_position.get_row(); int start_column = start_position.get_column();
-			int row_movement = new_position.get_row() - start_row; int column_movement = new_position.get_column() - start_column;
-			//since the queen can move like a rook and a bishop, check all of the movement conditions together for bishops rooks and queens
-			if (row_movement == 0 && column_movement < 0) {
-				// ROOK MOVEMENT, LEFT ALONG A ROW
-				for (int i = 1; i < -column_movement; i++) {
-					//if the piece has negative column_movement it is moving along a row from a high index number column to a low index number column
-					if (game_board[start_row][start_column - i].is_occupied() == true) return false;
-				}
-			}
-			else if (row_movement == 0 && column_movement > 0) {	// ROOK MOVEMENT, RIGHT ALONG A ROW
-				for (int i = 1; i < row_movement; i++) {
-					//if the piece has positive column_movement it is moving along a row from a low index number column to a high index number column
-					if (game_board[start_row][start_column + i].is_occupied() == true) return false;
-				}
-			}
-			else if (row_movement < 0 && column_movement == 0) {	// ROOK MOVEMENT, DOWN A COLUMN ON THE BOARD
-				for (int i = 1; i < -row_movement; i++) {
-					//if the piece has negative row_movement it is moving along a column from a hign index number row to a low index number row
-					if (game_board[start_row - i][start_column].is_occupied() == true) return false;
-				}
-			}
-			else if (row_movement > 0 && column_movement == 0) {	// ROOK MOVEMENT, UP A COLUMN ON THE BOARD
-				for (int i = 1; i < row_movement; i++) {
-					//if the piece has positive row_movement it is moving along a column from a low index number row to a high index number row
-					if (game_board[start_row + i][start_column].is_occupied() == true) return false;
-				}
-			}
-			if (row_movement < 0 && column_movement < 0) {			// BISHOP MOVEMENT, UP BOARD AND LEFT
-				for (int i = 1; i < -row_movement; i++) { //since "row_movement" is negative, take the negative of that 
-					//if the piece has negative row_movement and negative column movement it is moving from a high index number row to a low and a high index number column to a low one
-					if (game_board[start_row - i][start_column - i].is_occupied() == true) return false;
-				}
-			}
-			else if (row_movement < 0 && column_movement > 0) {		// BISHOP MOVEMENT, UP BOARD AND RIGHT
-				for (int i = 1; i < -row_movement; i++) {
-					//if the piece has negative row_movement and positive column movement it is moving from a high index number row to a low one and a low index number column to a high one
-					if (game_board[start_row - i][start_column + i].is_occupied() == true) return false;
-				}
-			}
-			else if (row_movement > 0 && column_movement < 0) {		// BISHOP MOVEMENT, DOWN BOARD AND LEFT
-				for (int i = 1; i < row_movement; i++) {
-					//if the piece has positive row_movement and negative column movement it is moving from a low index number row to a high one and a high index number column to a low one
-					if (game_board[start_row + i][start_column - i].is_occupied() == true) return false;
-				}
-			}
-			else if (row_movement > 0 && column_movement > 0) {		// BISHOP MOVEMENT, DOWN BOARD AND RIGHT
-				for (int i = 1; i < row_movement; i++) {
-					//if the piece has positive row_movement and positive column movement it is moving from a low index number row to a high one and a low index number column to a high one
-					if (game_board[start_row + i][start_column + i].is_occupied() == true) return false;
-				}
-			}
-			// if one of the loops doesn't return false then the no pieces lie in the way of the castle, bishop or queen and so the move is valid
-			return true;
-		}
-		else if (game_pieces[start_position]->get_identity() == pawn){
-			//deal with the pawn separately to queen bishop and rook since it's movement is a lot more specific
-			int start_row = start_position.get_row(); int start_column = start_position.get_column();
-			int row_movement = new_position.get_row() - start_row; int column_movement = new_position.get_column() - start_column;
-
-			if (game_pieces[start_position]->get_colour() == white) { //White pawns can only move up the board (since they start on the bottom side)
-				if (row_movement == -2){ //row_movement is negative since the white pawns move from high index number rows up the board to low index number rows
-					if (game_board[start_row - 1][start_column].is_occupied() == true) return false;
-				}
-			}
-			else {//else the pawn is black
-				if (row_movement == 2) { //row_movement is positive since the black pawns move from low index number rows down the board to high index number rows
-					if (game_board[start_row + 1][start_column].is_occupied() == true) return false;
-				}
-			}
-			//If it wasn't a black or white pawn moving two rows from its original position, or the path of pawns doing that was empty, the move is valid so return true
-			return true;
-		}
-		else{ //else the piece being move was not a pawn, queen, rook or bishop and the path of the piece does not need to be considered when deciding if the move is valid for the board
-			return true;
-		}
+	if (piece_moving != pawn_index) {
+		//every other piece can move to exactly the squares it attacks, the sliding pieces' attack sets stop at the first piece in their way so the
+		//path is checked at the same time as the movement
+		if (piece_attacks(team_colour, piece_moving, start_index, game_position.occupancy()) & square_bit(end_index)) return true;
+		//a king moving two squares along its row is castling, which is only allowed on the team's turn and when the king and rook haven't moved
+		if (piece_moving != king_index || team_colour != side_to_move || index_row(start_index) != index_row(end_index)) return false;
+		if (end_index != start_index + 2 && end_index != start_index - 2) return false;
+		return castling_allowed(game_position, attack_maps[opposite_colour(team_colour)], castling_rights, team_colour, end_index > start_index);
 	}
+	//deal with the pawn separately since it's movement is a lot more specific, it takes diagonally forward but only moves straight forward onto empty squares
+	if (end_occupied == true) return (pawn_attacks(team_colour, start_index) & square_bit(end_index)) != 0;
+	//or it takes a pawn which has just moved two squares past it en passant, landing on the square the pawn passed over
+	if (pawn_attacks(team_colour, start_index) & square_bit(end_index)) {
+		return team_colour == side_to_move && en_passant_column == index_column(end_index) && index_row(end_index) == (team_colour == white ? 2 : 5);
+	}
+	int forward = team_colour == white ? -8 : 8; //white pawns move up the board (towards row 0) and black pawns move down it
+	int start_row = team_colour == white ? 6 : 1;
+	if (end_index == start_index + forward) return true;
+	//a pawn on its starting row can move two squares if the square it passes over is empty
+	return end_index == start_index + 2 * forward && start_position.get_row() == start_row && game_position.is_occupied(start_index + forward) == false;
 }
 
-// [11] Function to locate and return the king location for a given team colour
+// [12] Function to locate and return the king location for a given team colour
 
 square board::find_king_square(colour king_colour){
-	for (auto const& piece : game_pieces) //auto iterating through game_pieces map
-	{	//piece.first = map key, piece.second = what's contained in that element
-		if (piece.second->get_identity() == king && piece.second->get_colour() == king_colour) return access_board_square(piece.first.get_row(), piece.first.get_column());
-	}
-	return square(); //in reality the board will never not have your king, this is just a formality
+	bitboard king_set = game_position.piece_sets[king_colour][king_index];
+	if (king_set == 0) return square(); //in reality the board will never not have your king, this is just a formality
+	int index = lowest_square(king_set); //the king piece set only ever contains one square
+	return access_board_square(index_row(index), index_column(index));
 }
 
-// [12] Function to check if the king is in check, looks to see if any pieces of opposing team are threatening to take the king
+// [13] Function to check if the king is in check, looks to see if any pieces of opposing team are threatening to take the king
 
-bool board::is_king_in_check(square &king_square, colour king_colour){
+bool board::is_king_in_check(const square &king_square, colour king_colour){
+	//The attack map of the opposite team is kept up to date by every move, so the king is in check exactly when its square is in that map
+	return (attack_maps[opposite_colour(king_colour)] & square_bit(square_index(king_square.get_row(), king_square.get_column()))) != 0;
+}
 
-	//Now we have found the king, lets see if any pieces are in a position to validly take the king unless a move is made to prevent this
-	//iterate through the game_pieces again looking at the opposite team and checking if their square to the kings square is a valid move
-	for (auto const& piece : game_pieces) //auto iterating through game_pieces map
-	{	//piece.first = map key, piece.second = what's contained in that element
-		if (piece.second->get_colour() != king_colour){ //if the piece is from the enemy team
-			square piece_square = game_board[piece.first.get_row()][piece.first.get_column()];
-			if (valid_board_move(piece.second->get_colour(), piece_square, king_square) == true){
-				return true; //KING IS IN CHECK
-			}
-		}
-	}
-	return false; //Else the KING IS NOT IN CHECK
+// [14] Function to check if a move can be made to get the king out of check, including taking the threat piece, blocking the threat piece or moving the king
+//      out of the way. Out of check it finds whether the team can move at all, so it tells stale mate apart too
 
+bool board::any_valid_moves(colour king_colour){
+	return has_legal_move(king_colour); //the legal move search already tries king moves first, then the pieces that can take or block the threat
 }
 
-// [13] Function to check if a move can be made to get the king out of check, including taking the threat piece, blocking the threat piece or moving the king out of the way
-
-bool board::any_valid_moves(colour king_colour){//include taking check piece, blocking path, moving king
-	square king_square = find_king_square(king_colour); int king_row = king_square.get_row(); int king_column = king_square.get_column();
-	std::vector < square > threat_squares; //In here we can store the positions that are threatening the king, including the squares in the path of the threat to the king
-	std::vector < square > team_squares; //In here we can store all of the team_square positions
-
-	//LAMBDAS
-	auto king_moves = [&]() -> bool { //[&] means it captures every variable and function currently in scope by reference
-		for (int i = -1; i < 2; i++){
-			for (int j = -1; j < 2; j++){ //Loop through all possible movement of the king
-				if (king_row + j < 8 && king_row + j >= 0 && king_column + i < 8 && king_column + i >= 0){
-					if (valid_board_move(king_colour, game_board[king_row][king_column], game_board[king_row + j][king_column + i]) == true){ //check if king can make any valid moves
-						// Create a temporary board to make this valid move on 
-						board temporary_board = board();
-						temporary_board = *this;
-
-						temporary_board.update_board(temporary_board.game_board[king_row][king_column], temporary_board.game_board[king_row + j][king_column + i]); //can update the board and return true to indicate the move has been made	
-						//check if the king is in check after making this move
-						if (temporary_board.is_king_in_check(temporary_board.find_king_square(king_colour), king_colour) == false) return true; //return true to indicate king can be moved out of check
-						// else keep looping through
-					}
-				}
-			}
-		}
-		return false; //if no king moves caused the lambda to return true then return false indicating the king can't be moved to get out of check
-	};
-	auto piece_moves = [&](int a, int b) -> bool { // "a" will be the index in the vector of team_squares that we will use to access the separate team squares
-		int team_piece_column = team_squares[a].get_column(); int team_piece_row = team_squares[a].get_row();
-		int threat_piece_column = threat_squares[b].get_column(); int threat_piece_row = threat_squares[b].get_row();
-		//Need to create a temporary copy of the chessboard and then we can see if each attempted move produces a playable board for the next move
-		//We are not looking to make any of these moves, just see if there are any possible moves for the user to find
+// [15] Function to list every move the pieces of a team can make, ignoring whether it leaves their king in check
 
-		if (valid_board_move(king_colour, game_board[team_piece_row][team_piece_column], game_board[threat_piece_row][threat_piece_column]) == true){
-			board temporary_board = board();
-			temporary_board = *this;
+void board::generate_pseudo_legal_moves(colour team_colour, move_list &moves) const { generate_moves(team_colour, moves, all_moves); }
 
-			temporary_board.update_board(temporary_board.game_board[team_piece_row][team_piece_column], temporary_board.game_board[threat_piece_row][threat_piece_column]); //can update the board and return true to indicate the move has been made	
+// [16] Function to check that a move doesn't leave the team's own king in check. When the king isn't in check, a piece that isn't the king and isn't pinned
+//      can always move safely, except when taking en passant, which takes two pieces off the same row and can uncover an attack along it. Otherwise the move
+//      is made on a copy of the position (which is only a few bitboards) and the king's square is tested for enemy attacks
 
-			if (temporary_board.is_king_in_check(temporary_board.find_king_square(king_colour), king_colour) == false) return true; //return true to indicate there are piece moves
-			else return false; //return false to indicate this isn't a valid piece move
-		}
-		else return false;
-	};
+bool board::leaves_king_safe(colour team_colour, const chess_move &m) const {
+	bitboard king_set = game_position.piece_sets[team_colour][king_index];
+	bool en_passant = (game_position.piece_sets[team_colour][pawn_index] & square_bit(m.from)) != 0 && index_column(m.from) != index_column(m.to)
+		&& game_position.is_occupied(m.to) == false;
+	if (check_pieces[team_colour] == 0 && ((pinned[team_colour] | king_set) & square_bit(m.from)) == 0 && en_passant == false) return true;
 
-	//Now we have found the king, lets see if any pieces are in a position to validly take the king unless a move is made to prevent this
-	//iterate through the game_pieces again looking at the opposite team and checking if their square to the kings square is a valid move
-	for (auto const& piece : game_pieces) //auto iterating through game_pieces map
-	{	//piece.first = map key, piece.second = what's contained in that element
-		square piece_square = piece.first;
-		if (piece.second->get_colour() != king_colour){ //if the piece is from the enemy team
-			if (valid_board_move(piece.second->get_colour(), piece_square, king_square) == true){
-				threat_squares.push_back(piece_square); //Lets store the threatening positions
-			}
-		}//else the piece is the same colour as the king 
-		else if (piece.second->get_identity() != king){ //so as long as it is not the king we can store it in the team_squares vector
-			team_squares.push_back(piece_square);
-		}
+	position after_move = game_position;
+	colour moving_colour, taken_colour; piece_index moving_type, taken_type;
+	after_move.find_piece(m.from, moving_colour, moving_type);
+	int taken_square = en_passant ? en_passant_square(m.from, m.to) : m.to;
+	if (after_move.find_piece(taken_square, taken_colour, taken_type) == true) after_move.remove_piece(taken_colour, taken_type, taken_square);
+	after_move.remove_piece(moving_colour, moving_type, m.from);
+	after_move.add_piece(moving_colour, moving_type, m.to);
+
+	king_set = after_move.piece_sets[team_colour][king_index];
+	if (king_set == 0) return true; //no king on the board, so it can't be left in check
+	return square_attacked(after_move, lowest_square(king_set), opposite_colour(team_colour)) == false;
+}
+
+// [17] Function to list every legal move for a team, the pseudo legal moves are generated into the caller's list and any that leave the king in check are removed
+
+void board::generate_legal_moves(colour team_colour, move_list &moves) const {
+	generate_pseudo_legal_moves(team_colour, moves);
+	for (int i = 0; i < moves.size();) {
+		if (leaves_king_safe(team_colour, moves[i]) == true) i++;
+		else moves.remove(i); //the last move is swapped into position i, so check position i again
 	}
+}
 
+// [18] Function to make a move on the board, the position is updated in place and the piece taken (if any) is stored in the undo record so that
+//      unmake_move can put the board back exactly as it was without ever copying the board. The Zobrist key is updated as the move is made, each piece
+//      taken off a square XORs its number out of the key and each piece put on a square XORs its number in. A pawn reaching the last row becomes the
+//      move's promotion piece (a queen if the move doesn't give one), a king moving two squares castles and brings the rook over it, and a pawn moving
+//      diagonally onto an empty square takes the pawn beside it en passant. The key from before the move is added to the history for finding repetitions
 
-	//We need to store the path squares from the threat_square to the king_square, in our threat_squares vector
-	//at the moment the maximum threat_squares there could be are 2 (if a piece moves to check the king, while moving out of the way of a piece that is now also checking the king)
-	//these threat squares aren't in the same path
-	piece_type threat_piece = game_pieces[threat_squares[0]]->get_identity();
-	if (threat_piece == queen || threat_piece == rook || threat_piece == bishop){
-		//we can add to the threat squares if it is one of these pieces		
-		int row_movement = threat_squares[0].get_row() - king_row; int column_movement = threat_squares[0].get_column() - king_column;
-		//since the queen can move like a rook and a bishop, check all of the movement conditions together for bishops rooks and queens
+move_undo board::make_move(const chess_move &m) {
+	move_undo undo; undo.move = m; undo.taken_piece = no_piece_taken; undo.taken_square = m.to;
+	for (int team = 0; team < 2; team++) {
+		undo.attack_maps[team] = attack_maps[team]; undo.check_pieces[team] = check_pieces[team]; undo.pinned[team] = pinned[team];
+	}
+	undo.zobrist_key = zobrist_key; undo.side_to_move = std::uint8_t(side_to_move); undo.castling_rights = castling_rights; undo.en_passant_column = en_passant_column;
+	undo.halfmove_clock = halfmove_clock;
+	undo.middle_game_score = piece_scores.middle_game; undo.end_game_score = piece_scores.end_game; undo.game_phase = piece_scores.phase;
+	colour moving_colour, taken_colour; piece_index moving_type, taken_type;
+	if (game_position.find_piece(m.from, moving_colour, moving_type) == false) { undo.taken_piece = no_move_made; return undo; } //there is no piece to move
+	if (moving_type == pawn_index && index_column(m.from) != index_column(m.to) && game_position.is_occupied(m.to) == false) {
+		undo.taken_square = std::uint8_t(en_passant_square(m.from, m.to)); //en passant
+	}
+	if (game_position.find_piece(undo.taken_square, taken_colour, taken_type) == true) { //if the move is taking a piece, the taken piece is removed from its piece set
+		game_position.remove_piece(taken_colour, taken_type, undo.taken_square);
+		zobrist_key ^= piece_key(taken_colour, taken_type, undo.taken_square);
+		piece_scores.remove_piece(taken_colour, taken_type, undo.taken_square);
+		undo.taken_piece = std::int8_t(taken_type);
+	}
+	piece_index placed_type = moving_type;
+	undo.move.promotion = no_promotion;
+	if (moving_type == pawn_index && (m.to < 8 || m.to >= 56)) { //a pawn on the last row is promoted
+		placed_type = m.promotion != no_promotion ? piece_index(m.promotion) : queen_index;
+		undo.move.promotion = std::uint8_t(placed_type);
+	}
+	bitboard changed = square_bit(m.from) | square_bit(m.to) | square_bit(undo.taken_square); //the squares whose pieces the move changes
+	game_position.remove_piece(moving_colour, moving_type, m.from); //then the moving piece is taken off its old square and put on its new one
+	game_position.add_piece(moving_colour, placed_type, m.to);
+	zobrist_key ^= piece_key(moving_colour, moving_type, m.from) ^ piece_key(moving_colour, placed_type, m.to);
+	piece_scores.remove_piece(moving_colour, moving_type, m.from); piece_scores.add_piece(moving_colour, placed_type, m.to);
+	if (moving_type == king_index && (m.to - m.from == 2 || m.from - m.to == 2)) { //castling, the rook lands on the square the king passed over
+		int rook_from = m.to > m.from ? m.from + 3 : m.from - 4, rook_to = (m.from + m.to) / 2;
+		game_position.remove_piece(moving_colour, rook_index, rook_from);
+		game_position.add_piece(moving_colour, rook_index, rook_to);
+		zobrist_key ^= piece_key(moving_colour, rook_index, rook_from) ^ piece_key(moving_colour, rook_index, rook_to);
+		changed |= square_bit(rook_from) | square_bit(rook_to);
+		piece_scores.remove_piece(moving_colour, rook_index, rook_from); piece_scores.add_piece(moving_colour, rook_index, rook_to);
+	}
 
-		if (row_movement == 0 && column_movement < -1) {// ROOK MOVEMENT, LEFT ALONG A ROW		
-			for (int i = 1; i < -column_movement; i++) {
-				threat_squares.push_back(game_board[king_row][king_column - i]);
-			}
-		}
-		else if (row_movement == 0 && column_movement > 1) {	// ROOK MOVEMENT, RIGHT ALONG A ROW
-			for (int i = 1; i < row_movement; i++) {
-				threat_squares.push_back(game_board[king_row][king_column + i]);
-			}
-		}
-		else if (row_movement < -1 && column_movement == 0) {	// ROOK MOVEMENT, DOWN A COLUMN ON THE BOARD
-			for (int i = 1; i < -row_movement; i++) {
-				threat_squares.push_back(game_board[king_row - i][king_column]);
-			}
+	//a king or rook leaving its starting square (or a rook being taken on it) loses the castling rights that depend on it
+	std::uint8_t new_rights = castling_rights & castling_rights_kept(m.from) & castling_rights_kept(m.to);
+	zobrist_key ^= zobrist_keys.castling[castling_rights] ^ zobrist_keys.castling[new_rights];
+	castling_rights = new_rights;
+
+	//a pawn pushed two squares can be taken en passant on the next move, the column only counts if an enemy pawn is beside the pawn to take it so that
+	//positions which can't differ in their moves don't get different keys
+	zobrist_key ^= en_passant_key(en_passant_column);
+	en_passant_column = no_en_passant;
+	if (moving_type == pawn_index && (m.from - m.to == 16 || m.to - m.from == 16)) {
+		bitboard beside = ((square_bit(m.to) & 0xfefefefefefefefeULL) >> 1) | ((square_bit(m.to) & 0x7f7f7f7f7f7f7f7fULL) << 1);
+		if (beside & game_position.piece_sets[opposite_colour(moving_colour)][pawn_index]) en_passant_column = std::int8_t(index_column(m.to));
+	}
+	zobrist_key ^= en_passant_key(en_passant_column);
+
+	//the halfmove clock counts the moves since a pawn moved or a piece was taken, and the move number goes up once both teams have moved
+	halfmove_clock = (moving_type == pawn_index || undo.taken_piece != no_piece_taken) ? 0 : halfmove_clock + 1;
+	if (moving_colour == black) fullmove_number++;
+	key_history[history_length++ % key_history_size] = undo.zobrist_key;
+
+	if (side_to_move == moving_colour) zobrist_key ^= zobrist_keys.black_to_move; //the turn passes to the other team
+	side_to_move = opposite_colour(moving_colour);
+	refresh_attack_maps(changed, undo.taken_piece != no_piece_taken); //only what the changed squares can reach is worked out again
+	return undo;
+}
+
+// [19] Function to take back a move made with make_move, the piece is moved back to its start square (as a pawn again if it was promoted), a castling
+//      rook is moved back to its corner and any piece the move took is put back on the square it was taken from. A move that make_move couldn't make
+//      (its start square was empty) is marked no_move_made in the undo record, and taking it back does nothing
+
+void board::unmake_move(const move_undo &undo) {
+	if (undo.taken_piece == no_move_made) return; //make_move had no piece to move and changed nothing
+	colour moving_colour; piece_index placed_type;
+	game_position.find_piece(undo.move.to, moving_colour, placed_type);
+	game_position.remove_piece(moving_colour, placed_type, undo.move.to);
+	game_position.add_piece(moving_colour, undo.move.promotion != no_promotion ? pawn_index : placed_type, undo.move.from);
+	if (placed_type == king_index && (undo.move.to - undo.move.from == 2 || undo.move.from - undo.move.to == 2)) {
+		int rook_from = undo.move.to > undo.move.from ? undo.move.from + 3 : undo.move.from - 4, rook_to = (undo.move.from + undo.move.to) / 2;
+		game_position.remove_piece(moving_colour, rook_index, rook_to);
+		game_position.add_piece(moving_colour, rook_index, rook_from);
+	}
+	if (undo.taken_piece != no_piece_taken) game_position.add_piece(opposite_colour(moving_colour), piece_index(undo.taken_piece), undo.taken_square);
+	history_length--;
+	side_to_move = colour(undo.side_to_move); castling_rights = undo.castling_rights; en_passant_column = undo.en_passant_column; zobrist_key = undo.zobrist_key;
+	halfmove_clock = undo.halfmove_clock;
+	piece_scores.middle_game = undo.middle_game_score; piece_scores.end_game = undo.end_game_score; piece_scores.phase = undo.game_phase;
+	if (moving_colour == black) fullmove_number--;
+	for (int team = 0; team < 2; team++) { //the attack maps from before the move are put back rather than worked out again
+		attack_maps[team] = undo.attack_maps[team]; check_pieces[team] = undo.check_pieces[team]; pinned[team] = undo.pinned[team];
+	}
+}
+
+// [28] Function to set up the board from a position in Forsyth-Edwards Notation (FEN), returns false if it can't be read. The fields are the pieces row by
+//      row from row 0 (rank 8), the team to move, the castling rights, the en passant square and optionally the halfmove clock and move number. The
+//      pieces are written straight into the bitboards as the text is read, nothing is copied or allocated
+
+bool board::from_fen(std::string_view fen) {
+	game_position.clear();
+	side_to_move = white; castling_rights = 0; en_passant_column = no_en_passant; halfmove_clock = 0; fullmove_number = 1; history_length = 0;
+	std::size_t i = 0;
+	auto next_field = [&]() -> bool { //skip the spaces to the next field, returns false if the text has ended
+		while (i < fen.size() && fen[i] == ' ') i++;
+		return i < fen.size();
+	};
+
+	//PIECES
+	int row = 0, column = 0;
+	for (; i < fen.size() && fen[i] != ' '; i++) {
+		char c = fen[i];
+		if (c == '/') {
+			if (column != 8 || ++row > 7) return false; //every row must have exactly 8 squares
+			column = 0;
 		}
-		else if (row_movement > 1 && column_movement == 0) {	// ROOK MOVEMENT, UP A COLUMN ON THE BOARD
-			for (int i = 1; i < row_movement; i++) {
-				threat_squares.push_back(game_board[king_row + i][king_column]);
-			}
+		else if (c >= '1' && c <= '8') {
+			column += c - '0';
+			if (column > 8) return false;
 		}
-		if (row_movement < -1 && column_movement < -1) {			// BISHOP MOVEMENT, UP BOARD AND LEFT
-			for (int i = 1; i < -row_movement; i++) {
-				threat_squares.push_back(game_board[king_row - i][king_column - i]);
+		else {
+			colour team = (c >= 'A' && c <= 'Z') ? white : black;
+			piece_index type;
+			switch (c | 0x20) { //lower case
+			case 'p':	type = pawn_index; break;
+			case 'n':	type = knight_index; break;
+			case 'b':	type = bishop_index; break;
+			case 'r':	type = rook_index; break;
+			case 'q':	type = queen_index; break;
+			case 'k':	type = king_index; break;
+			default:	return false;
 			}
+			if (column > 7) return false;
+			game_position.add_piece(team, type, square_index(row, column++));
 		}
-		else if (row_movement < -1 && column_movement > 1) {		// BISHOP MOVEMENT, UP BOARD AND RIGHT
-			for (int i = 1; i < -row_movement; i++) {
-				threat_squares.push_back(game_board[king_row - i][king_column + i]);
+	}
+	if (row != 7 || column != 8) return false;
+
+	//TEAM TO MOVE
+	if (next_field() == false) return false;
+	if (fen[i] == 'w') side_to_move = white;
+	else if (fen[i] == 'b') side_to_move = black;
+	else return false;
+	i++;
+
+	//CASTLING RIGHTS
+	if (next_field() == false) return false;
+	if (fen[i] == '-') i++;
+	else {
+		for (; i < fen.size() && fen[i] != ' '; i++) {
+			switch (fen[i]) {
+			case 'K':	castling_rights |= white_king_side; break;
+			case 'Q':	castling_rights |= white_queen_side; break;
+			case 'k':	castling_rights |= black_king_side; break;
+			case 'q':	castling_rights |= black_queen_side; break;
+			default:	return false;
 			}
 		}
-		else if (row_movement > 1 && column_movement < -1) {		// BISHOP MOVEMENT, DOWN BOARD AND LEFT
-			for (int i = 1; i < row_movement; i++) {
-				threat_squares.push_back(access_board_square(king_row + i, king_column - i));
-			}
+	}
+
+	//EN PASSANT SQUARE, the square behind a pawn that has just moved two squares, on rank 3 if black is to move and rank 6 if white is
+	if (next_field() == false) return false;
+	if (fen[i] == '-') i++;
+	else {
+		if (i + 1 >= fen.size() || fen[i] < 'a' || fen[i] > 'h') return false;
+		int passed_row = '8' - fen[i + 1];
+		if (passed_row != (side_to_move == white ? 2 : 5)) return false;
+		int pawn_square = square_index(side_to_move == white ? 3 : 4, fen[i] - 'a');
+		if ((game_position.piece_sets[opposite_colour(side_to_move)][pawn_index] & square_bit(pawn_square)) == 0) return false; //there must be a pawn that has just moved two squares
+		//the column is only kept if a pawn of the team to move is beside the pawn to take it, as make_move does, so the key matches the same position reached by moves
+		bitboard beside = ((square_bit(pawn_square) & 0xfefefefefefefefeULL) >> 1) | ((square_bit(pawn_square) & 0x7f7f7f7f7f7f7f7fULL) << 1);
+		if (beside & game_position.piece_sets[side_to_move][pawn_index]) en_passant_column = std::int8_t(fen[i] - 'a');
+		i += 2;
+	}
+
+	//HALFMOVE CLOCK AND MOVE NUMBER, both are optional and must be numbers if they are given
+	for (int field = 0; field < 2 && next_field() == true; field++) {
+		if (fen[i] < '0' || fen[i] > '9') return false;
+		unsigned number = 0;
+		for (; i < fen.size() && fen[i] >= '0' && fen[i] <= '9'; i++) {
+			number = number * 10 + unsigned(fen[i] - '0');
+			if (number > 65535) return false;
 		}
-		else if (row_movement > 1 && column_movement > 1) {		// BISHOP MOVEMENT, DOWN BOARD AND RIGHT
-			for (int i = 1; i < row_movement; i++) {
-				threat_squares.push_back(game_board[king_row + i][king_column + i]);
-			}
+		if (field == 0) halfmove_clock = std::uint16_t(number);
+		else fullmove_number = std::uint16_t(number > 0 ? number : 1);
+	}
+	if (next_field() == true) return false; //anything left over isn't part of a FEN
+
+	zobrist_key = position_key(game_position, side_to_move, castling_rights, en_passant_column);
+	piece_scores = score_position(game_position);
+	refresh_attack_maps();
+	return true;
+}
+
+// [29] Function to write the position in Forsyth-Edwards Notation into a buffer of max_fen_length characters, returns its length. The characters are written
+//      straight into the buffer (which ends with a 0 so it can be printed as a C string) without making any strings. The en passant square is only written
+//      when a pawn can take en passant, the same rule make_move and from_fen use
+
+int board::to_fen(char *buffer) const {
+	static const char piece_letters[number_of_piece_types] = { 'p', 'n', 'b', 'r', 'q', 'k' };
+	char *out = buffer;
+	auto write_number = [&](unsigned number) {
+		char digits[5]; int length = 0;
+		do { digits[length++] = char('0' + number % 10); number /= 10; } while (number > 0);
+		while (length > 0) *out++ = digits[--length];
+	};
+
+	for (int row = 0; row < 8; row++) {
+		int empty_squares = 0;
+		for (int column = 0; column < 8; column++) {
+			piece_code code = game_position.piece_codes[square_index(row, column)];
+			if (code == empty_square) { empty_squares++; continue; }
+			if (empty_squares > 0) { *out++ = char('0' + empty_squares); empty_squares = 0; }
+			char letter = piece_letters[code_type(code)];
+			*out++ = code_colour(code) == white ? char(letter - 'a' + 'A') : letter; //white pieces are upper case
 		}
-		//else do nothing
+		if (empty_squares > 0) *out++ = char('0' + empty_squares);
+		if (row < 7) *out++ = '/';
 	}
+	*out++ = ' '; *out++ = side_to_move == white ? 'w' : 'b'; *out++ = ' ';
+	if (castling_rights == 0) *out++ = '-';
+	if (castling_rights & white_king_side) *out++ = 'K';
+	if (castling_rights & white_queen_side) *out++ = 'Q';
+	if (castling_rights & black_king_side) *out++ = 'k';
+	if (castling_rights & black_queen_side) *out++ = 'q';
+	*out++ = ' ';
+	if (en_passant_column == no_en_passant) *out++ = '-';
+	else { *out++ = char('a' + en_passant_column); *out++ = side_to_move == white ? '6' : '3'; }
+	*out++ = ' '; write_number(halfmove_clock);
+	*out++ = ' '; write_number(fullmove_number);
+	*out = '\0';
+	return int(out - buffer);
+}
 
+// [32] Function to set up the board from a position and its state without reading any text, used to unpack stored positions. The en passant column is
+//      kept only when a pawn of the team to move can take en passant, the same rule as from_fen
+
+void board::set_position(const position &p, colour team, std::uint8_t castling, std::int8_t en_passant, int halfmoves, int move_number) {
+	game_position = p;
+	side_to_move = team; castling_rights = std::uint8_t(castling & all_castling_rights); en_passant_column = no_en_passant;
+	halfmove_clock = std::uint16_t(halfmoves); fullmove_number = std::uint16_t(move_number > 0 ? move_number : 1); history_length = 0;
+	if (en_passant >= 0 && en_passant < 8) {
+		int pawn_square = square_index(team == white ? 3 : 4, en_passant);
+		bitboard beside = ((square_bit(pawn_square) & 0xfefefefefefefefeULL) >> 1) | ((square_bit(pawn_square) & 0x7f7f7f7f7f7f7f7fULL) << 1);
+		if ((game_position.piece_sets[opposite_colour(team)][pawn_index] & square_bit(pawn_square)) && (beside & game_position.piece_sets[team][pawn_index]))
+			en_passant_column = en_passant;
+	}
+	zobrist_key = position_key(game_position, side_to_move, castling_rights, en_passant_column);
+	piece_scores = score_position(game_position);
+	refresh_attack_maps();
+}
 
-	//first check if a piece can move to relieve the check
-	int amount_of_team_squares = team_squares.size(); int amount_of_threat_squares = threat_squares.size();
+// [33] Function to count the earlier times the position has been reached with the same team to move. A position can only repeat while no pawn has moved
+//      and nothing has been taken, so only the keys since the halfmove clock was last reset are compared, and only every second one since the team to
+//      move has to be the same. The slot is stepped back through the key history instead of being found with a division for every key
+
+int board::repetitions() const {
+	std::uint32_t reach = std::min<std::uint32_t>({ halfmove_clock, history_length, std::uint32_t(key_history_size) });
+	std::uint32_t slot = history_length % key_history_size; //the slot the next key goes into, which holds the oldest key kept
+	int count = 0;
+	for (std::uint32_t back = 2; back <= reach; back += 2) {
+		slot = slot >= 2 ? slot - 2 : slot + key_history_size - 2;
+		if (key_history[slot] == zobrist_key) count++;
+	}
+	return count;
+}
 
-	for (int i = 0; i < amount_of_team_squares; i++){
-		for (int j = 0; j < amount_of_threat_squares; j++){
-			if (piece_moves(i, j) == true) {
-				team_squares.clear();
-				threat_squares.clear();
-				return true;
+// [35] Function to check if a team has any legal move, stopping at the first one found. Nothing is generated into a list and no move is made: the king's
+//      escapes are tried first using the enemy attack map (a square behind the king on a checking line is tested again with the king gone, since the map
+//      was made with the king blocking it), in double check only the king can move, and every other piece may only move onto the checking piece or the
+//      squares between it and the king. A pinned piece may only move along the line through its king, so no move has to be made on a copy of the position
+//      except en passant, which can uncover an attack along the row of the two pawns
+
+bool board::has_legal_move(colour team_colour) const {
+	colour enemy_colour = opposite_colour(team_colour);
+	const bitboard *team = game_position.piece_sets[team_colour];
+	bitboard own = game_position.team_occupancy[team_colour];
+	bitboard enemy = game_position.team_occupancy[enemy_colour];
+	bitboard occupied = own | enemy;
+	if (team[king_index] == 0) return own != 0; //no king to keep safe, positions from the console game always have one
+	int king = lowest_square(team[king_index]);
+
+	//KING, squares the enemy doesn't attack, checked again without the king in case it was hiding an attack along a checking line
+	bitboard escapes = king_attacks(king) & ~own & ~attack_maps[enemy_colour];
+	while (escapes) {
+		int to = pop_lowest_square(escapes);
+		if (check_pieces[team_colour] == 0 || attackers_to(game_position, to, enemy_colour, occupied ^ square_bit(king)) == 0) return true;
+	}
+	if (count_squares(check_pieces[team_colour]) > 1) return false; //double check, only the king could move
+
+	//the squares that stop a check: taking the checking piece or, for a sliding piece, standing between it and the king
+	bitboard targets = ~own;
+	if (check_pieces[team_colour] != 0) targets = check_pieces[team_colour] | between(king, lowest_square(check_pieces[team_colour]));
+
+	//PINNED PIECES can only move along the line through their king, which a knight never can
+	bitboard pinned_pieces = pinned[team_colour];
+	while (pinned_pieces) {
+		int from = pop_lowest_square(pinned_pieces);
+		colour piece_colour; piece_index type;
+		game_position.find_piece(from, piece_colour, type);
+		bitboard allowed = targets & line(king, from);
+		if (type == pawn_index) {
+			int forward = team_colour == white ? -8 : 8;
+			int start_row = team_colour == white ? 6 : 1;
+			bitboard pushes = 0;
+			if (game_position.is_occupied(from + forward) == false) {
+				pushes = square_bit(from + forward);
+				if (index_row(from) == start_row && game_position.is_occupied(from + 2 * forward) == false) pushes |= square_bit(from + 2 * forward);
 			}
+			if (((pawn_attacks(team_colour, from) & enemy) | pushes) & allowed) return true;
 		}
+		else if (type != knight_index && (piece_attacks(team_colour, type, from, occupied) & allowed)) return true;
 	}
 
-	//our last hope is the king can move to get out of check
-	if (king_moves() == true){
-		team_squares.clear();
-		threat_squares.clear();
-		return true;
+	//EVERY OTHER PIECE, a whole piece set at a time
+	bitboard free_pieces = ~pinned[team_colour];
+	bitboard pieces = team[knight_index] & free_pieces;
+	while (pieces) if (knight_attacks(pop_lowest_square(pieces)) & targets) return true;
+	pieces = (team[bishop_index] | team[queen_index]) & free_pieces;
+	while (pieces) if (bishop_attacks(pop_lowest_square(pieces), occupied) & targets) return true;
+	pieces = (team[rook_index] | team[queen_index]) & free_pieces;
+	while (pieces) if (rook_attacks(pop_lowest_square(pieces), occupied) & targets) return true;
+
+	const bitboard not_column_0 = 0xfefefefefefefefeULL; const bitboard not_column_7 = 0x7f7f7f7f7f7f7f7fULL;
+	bitboard pawns = team[pawn_index] & free_pieces;
+	bitboard pawn_moves;
+	if (team_colour == white) {
+		bitboard single_push = (pawns >> 8) & ~occupied;
+		pawn_moves = single_push | (((single_push & 0x0000ff0000000000ULL) >> 8) & ~occupied) | ((((pawns & not_column_0) >> 9) | ((pawns & not_column_7) >> 7)) & enemy);
 	}
-	else { // if king also can't move out of check and none of its team can relieve the threat then return false to indicate checkmate
-		team_squares.clear();
-		threat_squares.clear();
-		return false; //indicate check mate
+	else {
+		bitboard single_push = (pawns << 8) & ~occupied;
+		pawn_moves = single_push | (((single_push & 0x0000000000ff0000ULL) << 8) & ~occupied) | ((((pawns & not_column_0) << 7) | ((pawns & not_column_7) << 9)) & enemy);
 	}
+	if (pawn_moves & targets) return true;
+
+	//EN PASSANT, the only move left that is tried on a copy of the position
+	if (en_passant_column != no_en_passant && team_colour == side_to_move) {
+		int passed_square = square_index(team_colour == white ? 2 : 5, en_passant_column);
+		bitboard takers = pawn_attacks(enemy_colour, passed_square) & team[pawn_index];
+		while (takers) if (leaves_king_safe(team_colour, chess_move(pop_lowest_square(takers), passed_square)) == true) return true;
+	}
+	return false;
+}
+
+// [36] Function to find whether the game has ended for the team to move, and how. A team with no legal move is check mated if its king is in check and
+//      stale mated if it isn't, which is decided before the draw rules since a mate on the fiftieth move still wins
+
+game_state board::game_status() const {
+	if (has_legal_move(side_to_move) == false) return check_pieces[side_to_move] != 0 ? game_checkmate : game_stalemate;
+	if (halfmove_clock >= 100) return game_fifty_move_draw;
+	if (repetitions() >= 2) return game_repetition_draw;
+	return game_in_play;
+}
+
+// [37] Function to list the pseudo legal moves of one kind. Each piece type has its attacked squares looked up as a bitboard, and any attacked square in the
+//      targets (empty or enemy squares for all moves, enemy squares for noisy moves and empty squares for quiet moves) is a move. Pawns are handled a whole
+//      piece set at a time by shifting the pawn bitboard one row forward (a shift of 8 bits), white pawns move towards row 0 and black pawns towards row 7.
+//      Every promotion is noisy and en passant is noisy, castling is quiet. En passant and castling depend on the team to move, so they are only added for
+//      that team
+
+void board::generate_moves(colour team_colour, move_list &moves, move_kind kind) const {
+	moves.clear();
+	const bitboard *team = game_position.piece_sets[team_colour];
+	bitboard occupied = game_position.occupancy();
+	bitboard enemy = game_position.team_occupancy[opposite_colour(team_colour)];
+	bitboard targets = kind == all_moves ? ~game_position.team_occupancy[team_colour] : kind == noisy_moves ? enemy : ~occupied; //the squares the pieces can move to
+
+	//PAWNS
+	const bitboard not_column_0 = 0xfefefefefefefefeULL; const bitboard not_column_7 = 0x7f7f7f7f7f7f7f7fULL;
+	bitboard pawns = team[pawn_index];
+	bitboard single_push, double_push, take_left, take_right; int forward;
+	if (team_colour == white) {
+		single_push = (pawns >> 8) & ~occupied;
+		double_push = ((single_push & 0x0000ff0000000000ULL) >> 8) & ~occupied; //pawns that pushed from their starting row 6 onto row 5 can push again
+		take_left = ((pawns & not_column_0) >> 9) & enemy;
+		take_right = ((pawns & not_column_7) >> 7) & enemy;
+		forward = -8;
+	}
+	else {
+		single_push = (pawns << 8) & ~occupied;
+		double_push = ((single_push & 0x0000000000ff0000ULL) << 8) & ~occupied; //pawns that pushed from their starting row 1 onto row 2 can push again
+		take_left = ((pawns & not_column_0) << 7) & enemy;
+		take_right = ((pawns & not_column_7) << 9) & enemy;
+		forward = 8;
+	}
+	const bitboard last_rows = 0xff000000000000ffULL;
+	if (kind == noisy_moves) { single_push &= last_rows; double_push = 0; } //a push is only noisy if it promotes
+	else if (kind == quiet_moves) { single_push &= ~last_rows; take_left = 0; take_right = 0; }
+	add_pawn_moves(take_left, forward - 1, moves);
+	add_pawn_moves(take_right, forward + 1, moves);
+	add_pawn_moves(single_push, forward, moves);
+	add_pawn_moves(double_push, 2 * forward, moves);
+	if (en_passant_column != no_en_passant && team_colour == side_to_move && kind != quiet_moves) { //the pawns beside a pawn that has just moved two squares can take it en passant
+		int passed_square = square_index(team_colour == white ? 2 : 5, en_passant_column);
+		bitboard takers = pawn_attacks(opposite_colour(team_colour), passed_square) & pawns;
+		while (takers) moves.add(pop_lowest_square(takers), passed_square);
+	}
+
+	//KNIGHTS, BISHOPS, ROOKS, QUEENS AND THE KING
+	add_piece_moves<knight_index>(team[knight_index], occupied, targets, moves);
+	add_piece_moves<bishop_index>(team[bishop_index], occupied, targets, moves);
+	add_piece_moves<rook_index>(team[rook_index], occupied, targets, moves);
+	add_piece_moves<queen_index>(team[queen_index], occupied, targets, moves);
+	add_piece_moves<king_index>(team[king_index], occupied, targets, moves);
+
+	//CASTLING is the king moving two squares towards a rook, the rook then jumps over it
+	if (castling_rights != 0 && team_colour == side_to_move && check_pieces[team_colour] == 0 && kind != noisy_moves) {
+		bitboard enemy_attacks = attack_maps[opposite_colour(team_colour)];
+		int king = team_colour == white ? 60 : 4;
+		if (castling_allowed(game_position, enemy_attacks, castling_rights, team_colour, true) == true) moves.add(king, king + 2);
+		if (castling_allowed(game_position, enemy_attacks, castling_rights, team_colour, false) == true) moves.add(king, king - 2);
+	}
+}
+
+// [38] Function to check that a move from outside the move generator (a move from the transposition table or a killer move from another position) could
+//      be made in this position, ignoring whether it leaves the king in check. It follows the same rules as generate_moves without generating anything
+
+bool board::is_pseudo_legal(colour team_colour, const chess_move &m) const {
+	if (m.from > 63 || m.to > 63 || m.from == m.to || m.promotion > queen_index) return false;
+	colour piece_colour; piece_index type;
+	if (game_position.find_piece(m.from, piece_colour, type) == false || piece_colour != team_colour) return false;
+	if (game_position.team_occupancy[team_colour] & square_bit(m.to)) return false;
+	if (type != pawn_index) {
+		if (m.promotion != no_promotion) return false;
+		if (piece_attacks(team_colour, type, m.from, game_position.occupancy()) & square_bit(m.to)) return true;
+		if (type != king_index || team_colour != side_to_move || check_pieces[team_colour] != 0) return false;
+		if (index_row(m.from) != index_row(m.to) || (m.to != m.from + 2 && m.to != m.from - 2)) return false;
+		return castling_allowed(game_position, attack_maps[opposite_colour(team_colour)], castling_rights, team_colour, m.to > m.from);
+	}
+	if ((m.promotion != no_promotion) != (m.to < 8 || m.to >= 56)) return false; //a pawn promotes exactly when it reaches the last row
+	if (pawn_attacks(team_colour, m.from) & square_bit(m.to)) {
+		if (game_position.team_occupancy[opposite_colour(team_colour)] & square_bit(m.to)) return true;
+		return team_colour == side_to_move && en_passant_column == index_column(m.to) && index_row(m.to) == (team_colour == white ? 2 : 5);
+	}
+	int forward = team_colour == white ? -8 : 8;
+	if (m.to == m.from + forward) return game_position.is_occupied(m.to) == false;
+	return m.to == m.from + 2 * forward && index_row(m.from) == (team_colour == white ? 6 : 1) && game_position.is_occupied(m.from + forward) == false
+		&& game_position.is_occupied(m.to) == false;
 }
 
 // GAME_PLAYER CLASS
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-// [14]  Unparameterised player constructor
+// [40]  Unparameterised player constructor
 
 game_player::game_player() : team_colour{ white } {}
 
-// [15] Parameterised player constructor
+// [41] Parameterised player constructor
 
 game_player::game_player(colour team) : team_colour{ team } {}
 
-// [16] Player destructor
+// [42] Player destructor
 
 game_player::~game_player() {}
 
-// [17] Function to access game_player's team_colour
+// [43] Function to access game_player's team_colour
 
 colour game_player::get_team_colour()const{ return team_colour; }
 
-// [18] Attempt move function- When the player attempts a move this function will return false if it is not possible. If the move is possible the board is updated with the move and the function returns true
+// [44] Attempt move function- When the player attempts a move this function will return false if it is not possible. If the move is possible the board is updated with the move and the function returns true
 
 bool game_player::attempt_move(board &chessboard) {
 	// Check that a piece to be moved actually occupies in the start_position square, and check that it belongs to the players team colour
@@ -466,16 +736,21 @@ bool game_player::attempt_move(board &chessboard) {
 
 	if (from_column <= 8 && from_column > 0 && from_row <= 8 && from_row > 0 && to_column <= 8 && to_column > 0 && to_row <= 8 && to_row > 0) {
 		if (chessboard.valid_board_move(get_team_colour(), chessboard.access_board_square(from_row - 1, from_column - 1), chessboard.access_board_square(to_row - 1, to_column - 1)) == true){ //if the board move is valid
-			//create a temporary version of this board and check on this board if your king is now check, if it is then the move is not valid, if it isn't then the move can be updated on your main board
-			board temporary_board{ board() }; //MAY NEED TO DEEP COPY THIS
-			temporary_board = chessboard;
-			temporary_board.update_board(temporary_board.access_board_square(from_row - 1, from_column - 1), temporary_board.access_board_square(to_row - 1, to_column - 1)); //can update the board and return true to indicate the move has been made
+			//make the move on the board and check if your king is now in check, if it is then the move is not valid and is taken back, if it isn't then the move is kept
+			chess_move attempted(square_index(from_row - 1, from_column - 1), square_index(to_row - 1, to_column - 1));
+			//a pawn reaching the last row is promoted, the player picks the piece and anything that isn't a rook, bishop or knight makes a queen
+			if ((chessboard.get_position().piece_sets[team_colour][pawn_index] & square_bit(attempted.from)) && (to_row == 1 || to_row == 8)) {
+				std::string promotion;
+				std::cout << "Promote to (Q, R, B or N): "; std::getline(std::cin, promotion);
+				char letter = promotion.empty() ? 'Q' : char(promotion[0] & ~0x20); //upper case
+				attempted.promotion = std::uint8_t(letter == 'R' ? rook_index : letter == 'B' ? bishop_index : letter == 'N' ? knight_index : queen_index);
+			}
+			move_undo undo = chessboard.make_move(attempted);
 
-			if (temporary_board.is_king_in_check(temporary_board.find_king_square(team_colour), team_colour) == false){
-				chessboard.update_board(chessboard.access_board_square(from_row - 1, from_column - 1), chessboard.access_board_square(to_row - 1, to_column - 1));
+			if (chessboard.is_king_in_check(chessboard.find_king_square(team_colour), team_colour) == false){
 				return true;
-			}//else the king is in check after this proposed move, so don't update the board and return false
-			else { std::cerr << "Invalid Move!" << std::endl; return false; }
+			}//else the king is in check after this proposed move, so take it back and return false
+			else { chessboard.unmake_move(undo); std::cerr << "Invalid Move!" << std::endl; return false; }
 		}
 		else { std::cerr << "Invalid Move!" << std::endl; return false; } //else the move was not valid for the board, so return false so this function can be called again in the main function until a valid move is input	
 	}
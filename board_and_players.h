@@ -9,45 +9,98 @@
 #define BOARD_AND_PLAYERS_H
 
 #include "board_components.h"
-#include <map>
+#include "bitboard.h"
+#include "chess_move.h"
+#include "evaluation.h"
+#include <string_view>
+#include <type_traits>
+
+const char start_fen[] = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";				// The starting position of a game of chess in Forsyth-Edwards Notation
+const int max_fen_length = 96;																			// A buffer of this many characters holds the FEN of any position written by board::to_fen
+const int key_history_size = 100;																		// The number of earlier position keys a board keeps to find repetitions, the fifty move rule
+																										// ends the game 100 moves after a pawn moves or a piece is taken so older keys never repeat
+enum move_kind { all_moves, noisy_moves, quiet_moves };																	// Which moves to generate, noisy moves are captures and promotions
+enum game_state { game_in_play, game_checkmate, game_stalemate, game_fifty_move_draw, game_repetition_draw };	// How the game stands for the team to move
 																										// BOARD CLASS
 class board																								//--------------------------------------------------------------------------------------------------------
 {
-	friend std::ostream & operator<<(std::ostream &os, board &b);										// [1]  Board friend function for outputing board objects to console 
+	friend std::ostream & operator<<(std::ostream &os, const board &b);									// [1]  Board friend function for outputing board objects to console 
 private:
-	square **game_board; // "game_board" is a 2D array of squares
-	std::map<square,piece*> game_pieces; // Map is our associative container where a square is the key
+	position game_position; // "game_position" holds a bitboard for each of the twelve piece sets, it is stored by value so the board needs no heap memory
+	bitboard attack_maps[2];  // The squares attacked by each team, indexed by [colour], kept up to date by every move
+	bitboard check_pieces[2]; // The enemy pieces giving check to each team's king
+	bitboard pinned[2];       // The pieces of each team that are pinned to their own king
+	colour side_to_move;      // The team whose turn it is, every move passes the turn to the other team
+	std::uint8_t castling_rights;    // The castling_right bits that are still allowed
+	std::int8_t en_passant_column;   // The column a pawn just pushed two squares along if an enemy pawn is beside it to take it, otherwise no_en_passant
+	std::uint64_t zobrist_key;       // The Zobrist key of the position, side to move, castling rights and en passant column, updated by every move
+	piece_square_score piece_scores; // The material and piece-square score and game phase of the position (see evaluation.h), updated by every move
+	std::uint16_t halfmove_clock;    // The number of moves since a pawn last moved or a piece was taken
+	std::uint16_t fullmove_number;   // The number of the move being played, starting at 1 and going up after each black move
+	std::uint32_t history_length;    // The number of moves made since the board was set up
+	std::uint64_t key_history[key_history_size]; // The keys of the positions before the last key_history_size moves, the key from n moves ago is at
+	                                             // [(history_length - n) % key_history_size], so a board still copies as one fixed size block
 	
-	// NOTE!! To make custom classes, in this case the square, work as keys for std::map containers we need to provide a way for the map to sort the keys 
-	// [2] The "<" operator was overloaded for the comparison of two squares objects so that they could be used as a key in the map of pieces, or an unordered_map could be used		
+	bool piece_on_square(int index, colour &piece_colour, piece_type &type_of_piece) const;				// [2]  Function to identify the piece and team occupying a square of the position
+	void refresh_attack_maps(bitboard changed = ~bitboard(0), bool taking = true);						// [3]  Function to work out the attack maps, checking pieces and pinned pieces again after the pieces on some squares changed
 
 public:
-	void look_at_map();																					// [3]  Function to output our map (the keys and corresponding pieces of each element in the map, good for error checking) 
-	board();																							// [4]  Unparameterised board constructor
-	~board();																							// [5]  Board destructor
-	board &operator=(board &b);																			// [6]  Operator overloaded for "=" for board object
+	void look_at_map();																					// [4]  Function to output every piece on the board with the square it occupies (good for error checking) 
+	board();																							// [5]  Unparameterised board constructor
+	~board() = default;																					// [6]  Board destructor, the board owns no memory so there is nothing to release
+	board(const board &b) = default;																	// [7]  Copy and move constructors and assignment operators, a board is a fixed size
+	board(board &&b) = default;																			//      value made of bitboards and numbers so copying it copies every member and
+	board &operator=(const board &b) = default;															//      nothing is shared between the copies
+	board &operator=(board &&b) = default;
 	
-	square access_board_square(int row, int column) const;												// [7]  Function to allow access to one of the 2D "game_board" squares
-	void add_Map_element(square &new_key, piece* &piece_to_contain);									// [8]  Function to add a new element to our map (introduce a new square to the map which contains a piece) 
-	void update_board(square &piece_start, square &piece_end);											// [9]  Function to update the chess board with a move		
-	bool valid_board_move(colour team_colour, square &start_position, square &end_position);			// [10] Function to check if a move is valid for the board
-	square find_king_square(colour king_colour);														// [11] Function to locate and return the king location for a given team colour
-	bool is_king_in_check(square &king_square, colour king_colour);										// [12] Function to check if the king is in check 
-	bool any_valid_moves(colour king_colour);															// [13] Function to check if a move can be made to get the king out of check
+	square access_board_square(int row, int column) const;												// [8]  Function to allow access to one of the squares of the board
+	void add_piece(const square &new_square, colour piece_colour, piece_type type_of_piece);			// [9]  Function to put a new piece onto an empty square of the board
+	void update_board(const square &piece_start, const square &piece_end);								// [10] Function to update the chess board with a move		
+	bool valid_board_move(colour team_colour, const square &start_position, const square &end_position);	// [11] Function to check if a move is valid for the board
+	square find_king_square(colour king_colour);														// [12] Function to locate and return the king location for a given team colour
+	bool is_king_in_check(const square &king_square, colour king_colour);								// [13] Function to check if the king is in check 
+	bool any_valid_moves(colour king_colour);															// [14] Function to check if a move can be made to get the king out of check (or any move at all)
+	void generate_pseudo_legal_moves(colour team_colour, move_list &moves) const;						// [15] Function to list every move the pieces of a team can make, ignoring whether it leaves their king in check
+	bool leaves_king_safe(colour team_colour, const chess_move &m) const;								// [16] Function to check that a move doesn't leave the team's own king in check
+	void generate_legal_moves(colour team_colour, move_list &moves) const;								// [17] Function to list every legal move for a team
+	move_undo make_move(const chess_move &m);															// [18] Function to make a move on the board, returning the record needed to take it back
+	void unmake_move(const move_undo &undo);															// [19] Function to take back a move made with make_move
+	bitboard attacked_squares(colour attacking_colour) const { return attack_maps[attacking_colour]; }	// [20] Function to retrieve every square attacked by a team
+	bitboard checking_pieces(colour king_colour) const { return check_pieces[king_colour]; }			// [21] Function to retrieve the enemy pieces giving check to a team's king
+	bitboard pinned_pieces(colour king_colour) const { return pinned[king_colour]; }					// [22] Function to retrieve the pieces of a team pinned to their own king
+	std::uint64_t hash_key() const { return zobrist_key; }												// [23] Function to retrieve the Zobrist key which identifies the position
+	colour team_to_move() const { return side_to_move; }												// [24] Function to retrieve the team whose turn it is
+	std::uint8_t castling() const { return castling_rights; }											// [25] Function to retrieve the castling rights still allowed
+	std::int8_t en_passant() const { return en_passant_column; }										// [26] Function to retrieve the column a pawn can be taken en passant on
+	const position &get_position() const { return game_position; }										// [27] Function to access the bitboards of the position
+	bool from_fen(std::string_view fen);																// [28] Function to set up the board from a position in Forsyth-Edwards Notation, returns false if it can't be read
+	int to_fen(char *buffer) const;																		// [29] Function to write the position in Forsyth-Edwards Notation into a buffer of max_fen_length characters, returns its length
+	int halfmoves() const { return halfmove_clock; }													// [30] Function to retrieve the number of moves since a pawn last moved or a piece was taken
+	int move_number() const { return fullmove_number; }													// [31] Function to retrieve the number of the move being played
+	void set_position(const position &p, colour team, std::uint8_t castling, std::int8_t en_passant, int halfmoves, int move_number);	// [32] Function to set up the board from a position and its state without reading any text
+	int repetitions() const;																			// [33] Function to count the earlier times the position has been reached with the same team to move
+	bool draw_by_rule() const { return halfmove_clock >= 100 || repetitions() >= 2; }					// [34] Function to check for a draw by the fifty move rule or by threefold repetition
+	bool has_legal_move(colour team_colour) const;														// [35] Function to check if a team has any legal move, stopping at the first one found
+	game_state game_status() const;																		// [36] Function to find whether the game has ended for the team to move, and how
+	void generate_moves(colour team_colour, move_list &moves, move_kind kind) const;					// [37] Function to list the pseudo legal moves of one kind, so a search can leave the quiet moves until it needs them
+	bool is_pseudo_legal(colour team_colour, const chess_move &m) const;								// [38] Function to check that a move from outside the move generator (such as a stored move) could be made, ignoring king safety
+	const piece_square_score &piece_square() const { return piece_scores; }								// [39] Function to retrieve the material and piece-square score of the position, kept up to date by every move
 };
 
+static_assert(std::is_trivially_copyable<board>::value, "a board must copy like an int, with no heap memory behind it");
+
 																										// PLAYER CLASS
 class game_player																						//--------------------------------------------------------------------------------------------------------
 {
 private:
 	colour team_colour;	// Player is defined by what their team colour is, white or black
 public:
-	game_player();																						// [14] Unparameterised player constructor
-	game_player(colour team);																			// [15] Parameterised player constructor
-	~game_player();																						// [16] Player destructor
+	game_player();																						// [40] Unparameterised player constructor
+	game_player(colour team);																			// [41] Parameterised player constructor
+	~game_player();																						// [42] Player destructor
 
-	colour get_team_colour()const;																		// [17] Function to access game_player's team_colour
-	bool attempt_move(board &chessboard);																// [18] Function to allow player to attempt to make a move
+	colour get_team_colour()const;																		// [43] Function to access game_player's team_colour
+	bool attempt_move(board &chessboard);																// [44] Function to allow player to attempt to make a move
 };
 
 #endif
\ No newline at end of file
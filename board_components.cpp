@@ -62,7 +62,7 @@ int square::get_row() const { return row_position; }
 int square::get_column() const { return column_position; }
 
 
-// PIECE ABSTRACT BASE CLASS
+// PIECE CLASS
 //--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 // [10] Piece friend function for outputing piece objects to console 
 
@@ -90,7 +90,7 @@ piece::piece(piece_type type_of_piece) : identity{ type_of_piece }, team_colour{
 
 piece::piece(square piece_position, const colour piece_colour, piece_type type_of_piece) : position{ piece_position }, team_colour{ piece_colour }, identity{ type_of_piece } {}
 
-// [14] Virtual piece destructor (makes class abstract as cannot construct a piece now)
+// [14] Piece destructor
 
 piece:: ~piece() {};
 
@@ -121,193 +121,3 @@ square piece::get_square() const { return position; }
 // [19] Function for updating the square that the piece believes it is in
 
 void piece::update_position(const square &new_position) { position = new_position; }
-
-// [20] Virtual function for checking a piece can move in the requested way (to be overidden by derived pieces) 
-
-bool piece::valid_piece_movement(const square &start_square, const square &end_square) const{ return false; }
-
-
-// KING CLASS
-//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-// [21] Unparameterised king constructor
-
-King::King() : piece(king) {}
-
-// [22] Parameterised king constructor
-
-King::King(const square &piece_position, const colour piece_colour) : piece(piece_position, piece_colour, king) {}
-
-// [23] King destructor
-
-King::~King() {};
-
-// [24] Overidden function to check King is moving in a valid way
-
-bool King::valid_piece_movement(const square &start_square, const square &end_square) const {
-	// First access the end_square column and row co-ordinates and subtract the column and row co-ordinates of the start_square from these values
-	int column_movement = end_square.get_column() - start_square.get_column(); int row_movement = end_square.get_row() - start_square.get_row();
-	// Now have the numbers representing the piece movement on the board, check if they are valid for a king's mobility (a king can move vertically, horizontally or diagonally to any square one square away)
-	if (column_movement == 0 && row_movement == 0) return false; // staying still is not a valid piece movement
-	else if (std::abs(column_movement) <= 1 && std::abs(row_movement) <= 1)  return true; //moving to any surrounding square is a valid piece movement
-	else return false; //else the move is not valid
-}
-
-
-// QUEEN CLASS
-//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-// [25] Unparameterised queen constructor
-
-Queen::Queen() : piece(queen) {}
-
-// [26] Parameterised queen constructor
-
-Queen::Queen(const square &piece_position, const colour piece_colour) : piece(piece_position, piece_colour, queen) {}
-
-// [27] Queen destructor
-
-Queen::~Queen() {};
-
-// [28] Overidden function to check queen is moving in a valid way
-
-bool Queen::valid_piece_movement(const square &start_square, const square &end_square) const {
-	// First access the end_square column and row co-ordinates and subtract the column and row co-ordinates of the start_square from these values
-	int column_movement = end_square.get_column() - start_square.get_column(); int row_movement = end_square.get_row() - start_square.get_row();
-
-	//queen has movement capabilities of bishop and a rook (which is that it can move horizontally, vertically, like a rook, or diagonally, like a bishop, as far as the board permits)
-	if (column_movement == 0 && row_movement == 0) return false; //staying still is not a valid piece movement
-	else if ((std::abs(column_movement) < 8 && row_movement == 0) || (column_movement == 0 && std::abs(row_movement) < 8)) return true; //moving vertically along a column or horizontally along a row is a valid piece movement
-	else if (std::abs(column_movement) == std::abs(row_movement)) return true; //moving along diagonals like a bishop is also valid
-	else return false; //else the proposed movement is not valid
-}
-
-
-// ROOK CLASS
-//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-// [29] Unparameterised rook constructor
-
-Rook::Rook() : piece(rook) {}
-
-// [30] Parameterised rook constructor
-
-Rook::Rook(const square &piece_position, const colour piece_colour) : piece(piece_position, piece_colour, rook) {}
-
-// [31] Rook destructor
-
-Rook::~Rook() {};
-
-// [32] Overidden function to check rook is moving in a valid way
-
-bool Rook::valid_piece_movement(const square &start_square, const square &end_square) const{
-	// First access the end_square column and row co-ordinates and subtract the column and row co-ordinates of the start_square from these values
-	int column_movement = end_square.get_column() - start_square.get_column(); int row_movement = end_square.get_row() - start_square.get_row();
-
-	if (column_movement == 0 && row_movement == 0) return false; //staying still is not a valid piece movement
-	else if ((std::abs(column_movement) < 8 && row_movement == 0) || (column_movement == 0 && std::abs(row_movement) < 8)) 	return true; //moving vertically along a column or horizontally along a row is a valid piece movement	
-	else return false; //any other proposed movement is not valid
-}
-
-
-// BISHOP CLASS
-//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-// [33] Unparameterised bishop constructor
-
-Bishop::Bishop() : piece(bishop) {}
-
-// [34] Parameterised bishop constructor
-
-Bishop::Bishop(const square &piece_position, const colour piece_colour) : piece(piece_position, piece_colour, bishop) {}
-
-// [35] Bishop destructor
-
-Bishop::~Bishop() {};
-
-// [36] Overidden function to check bishop is moving in a valid way
-
-bool Bishop::valid_piece_movement(const square &start_square, const square &end_square) const {
-	// First access the end_square column and row co-ordinates and subtract the column and row co-ordinates of the start_square from these values
-	int column_movement = end_square.get_column() - start_square.get_column(); int row_movement = end_square.get_row() - start_square.get_row();
-	if (column_movement == 0 && row_movement == 0) return false; //staying still is not a valid piece movement
-	if (std::abs(column_movement) == std::abs(row_movement))  return true;
-	else return false;
-}
-
-
-// KNIGHT CLASS
-//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-// [37] Unparameterised knight constructor
-
-Knight::Knight() : piece(knight) {}
-
-// [38] Parameterised knight constructor
-
-Knight::Knight(const square &piece_position, const colour piece_colour) : piece(piece_position, piece_colour, knight) {}
-
-// [39] Knight destructor
-
-Knight::~Knight() {};
-
-// [40] Overidden function to check knight is moving in a valid way
-
-bool Knight::valid_piece_movement(const square &start_square, const square &end_square)const {
-	// First access the end_square column and row co-ordinates and subtract the column and row co-ordinates of the start_square from these values
-	int column_movement = end_square.get_column() - start_square.get_column(); int row_movement = end_square.get_row() - start_square.get_row();
-	if ((std::abs(column_movement) == 2 && std::abs(row_movement) == 1) || (std::abs(column_movement) == 1 && std::abs(row_movement) == 2)) return true;
-	else return false;
-}
-
-
-// PAWN CLASS
-//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
-// [41] Unparameterised pawn constructor
-
-Pawn::Pawn() : piece(pawn) {}
-
-// [42] Parameterised pawn constructor
-
-Pawn::Pawn(const square &piece_position, const colour piece_colour) : piece(piece_position, piece_colour, pawn) {}
-
-// [43] Pawn destructor
-
-Pawn::~Pawn() {};
-
-// [44] Overidden function to check pawn is moving in a valid way
-
-bool Pawn::valid_piece_movement(const square &start_square, const square &end_square) const {
-	// First access the end_square column and row co-ordinates and subtract the column and row co-ordinates of the start_square from these values
-	int column_movement = end_square.get_column() - start_square.get_column(); int row_movement = end_square.get_row() - start_square.get_row();
-
-	if (column_movement == 0 && row_movement == 0) return false; //staying still is not a valid piece movement
-
-	//Pawns are unique from the other pieces in that they move diagonally forward to take pieces, but move forward along a column of the board if they are not taking a piece
-	if (end_square.is_occupied() == true) { //when pawn is moving to take a piece
-		if (get_colour() == white) {
-			if (std::abs(column_movement) == 1 && row_movement == -1) return true; //for white pawns moving forward corresponds to negative row movement, here we check they are moving forward and diagonally
-			else return false;
-		}
-		else { //colour of piece is black
-			if (std::abs(column_movement) == 1 && row_movement == 1) return true; //for black pawns moving forwards corresponds to positive row movement
-			else return false;
-		}
-	}
-	else { // the pawn is not taking a piece and the piece is only allowed to move along the same column it is in
-		if (get_colour() == white && get_square().get_row() == 6) { //There is another condition when pawns are in their starting positons they are allowed to move forwards two squares or one
-			if (column_movement == 0 && (row_movement == -1 || row_movement == -2)) return true;
-			else return false;
-		}
-		else if (get_colour() == black && get_square().get_row() == 1) { //Black pawns in their starting row are also allowed to move 2 or 1 spaces forward 
-			if (column_movement == 0 && (row_movement == 1 || row_movement == 2)) return true;
-			else return false;
-		}
-		else if (get_colour() == white) { //if the pieces aren't in their starting positon they can only move one square forward
-			if (column_movement == 0 && row_movement == -1) return true;
-			else return false;
-		}
-		else {//colour of piece is black
-			if (column_movement == 0 && row_movement == 1) return true;
-			else return false;
-		}
-	}
-}
-
-
-
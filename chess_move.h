@@ -0,0 +1,97 @@
+// chess_move.h declares the chess_move struct, a move stored as the bit indices of its start and end squares and the piece a pawn promotes to, the move_list class which is a fixed
+// size buffer of moves and the move_undo struct which records what a move changed so the board can take it back. A move_list holds enough moves for any
+// chess position, so it can live on the stack and the move generator never needs the heap
+
+#ifndef CHESS_MOVE_H
+#define CHESS_MOVE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+const std::uint8_t no_promotion = 0;		// The promotion of a move which isn't a pawn reaching the last row (0 is the pawn's piece_index, which a pawn can't become)
+
+																																// CHESS_MOVE STRUCT
+struct chess_move {																												//--------------------------------------------------------------------------------------------------------
+	std::uint8_t from;		// Bit index of the square the piece moves from
+	std::uint8_t to;		// Bit index of the square the piece moves to
+	std::uint8_t promotion;	// The piece_index of the piece a pawn becomes on the last row, or no_promotion. Castling is the king moving two squares and
+							// en passant is a pawn taking diagonally onto an empty square, so neither needs marking in the move
+
+	chess_move() = default;																										// [1]  Unparameterised chess_move constructor
+	chess_move(int from_index, int to_index, int promotion_piece = no_promotion)												// [2]  Parameterised chess_move constructor
+		: from{ std::uint8_t(from_index) }, to{ std::uint8_t(to_index) }, promotion{ std::uint8_t(promotion_piece) } {}
+};
+
+inline bool operator==(const chess_move &lhs, const chess_move &rhs) { return lhs.from == rhs.from && lhs.to == rhs.to && lhs.promotion == rhs.promotion; }	// [3]  Overload "==" to compare two moves
+
+inline std::uint16_t pack_move(const chess_move &m) { return std::uint16_t(m.from | (m.to << 6) | (m.promotion << 12)); }		// [4]  Function to pack a move into 16 bits, 6 bits for each square and 4 for the promotion
+inline chess_move unpack_move(std::uint16_t packed) { return chess_move(packed & 63, (packed >> 6) & 63, (packed >> 12) & 15); }	// [5]  Function to unpack a move packed with pack_move
+
+inline std::string move_text(const chess_move &m) {																				// [6]  Function to write a move in coordinate notation (e.g. "e2e4" or "e7e8q"), columns are files a-h and
+	std::string text(m.promotion != no_promotion ? 5 : 4, ' ');																	//      row 0 is rank 8
+	text[0] = char('a' + (m.from & 7)); text[1] = char('8' - (m.from >> 3));
+	text[2] = char('a' + (m.to & 7)); text[3] = char('8' - (m.to >> 3));
+	if (m.promotion != no_promotion) text[4] = " nbrq"[m.promotion & 7];
+	return text;
+}
+
+inline bool parse_move_text(std::string_view text, chess_move &m) {																// [7]  Function to read a move in coordinate notation, returns false if the text isn't a move
+	if (text.size() < 4 || text.size() > 5 || text[0] < 'a' || text[0] > 'h' || text[1] < '1' || text[1] > '8' || text[2] < 'a' || text[2] > 'h' || text[3] < '1' || text[3] > '8') return false;
+	int promotion_piece = no_promotion;
+	if (text.size() == 5) { //the promotion piece as a letter, knight = 1 up to queen = 4 as in piece_index
+		switch (text[4] | 0x20) {
+		case 'n':	promotion_piece = 1; break;
+		case 'b':	promotion_piece = 2; break;
+		case 'r':	promotion_piece = 3; break;
+		case 'q':	promotion_piece = 4; break;
+		default:	return false;
+		}
+	}
+	m = chess_move(('8' - text[1]) * 8 + (text[0] - 'a'), ('8' - text[3]) * 8 + (text[2] - 'a'), promotion_piece);
+	return true;
+}
+
+																																// MOVE_LIST CLASS
+class move_list {																												//--------------------------------------------------------------------------------------------------------
+public:
+	static const int capacity = 256;	// No legal chess position has more than 218 moves
+private:
+	chess_move moves[capacity];
+	int number_of_moves;
+public:
+	move_list() : number_of_moves{ 0 } {}																						// [8]  Unparameterised move_list constructor, the list starts empty
+
+	void clear() { number_of_moves = 0; }																						// [9]  Function to empty the list
+	void add(int from, int to, int promotion = no_promotion) { moves[number_of_moves++] = chess_move(from, to, promotion); }	// [10] Function to add a move to the end of the list
+	void remove(int i) { moves[i] = moves[--number_of_moves]; }																	// [11] Function to remove a move by swapping the last move into its place
+	int size() const { return number_of_moves; }																				// [12] Function to retrieve the number of moves in the list
+	const chess_move &operator[](int i) const { return moves[i]; }																// [13] Function to access a move in the list
+	void swap(int i, int j) { chess_move m = moves[i]; moves[i] = moves[j]; moves[j] = m; }										// [14] Function to swap two moves, used to put the best moves first
+	const chess_move *begin() const { return moves; }																			// [15] Functions so the list can be used in range based for loops
+	const chess_move *end() const { return moves + number_of_moves; }
+};
+
+																																// MOVE_UNDO STRUCT
+struct move_undo {																												//--------------------------------------------------------------------------------------------------------
+	chess_move move;				// The move that was made
+	std::int8_t taken_piece;		// The piece_index of the piece the move took, no_piece_taken if the end square was empty, or no_move_made if
+									// there was no piece to move and the board was left as it was
+	std::uint8_t taken_square;		// The square the taken piece stood on, which is only different from the end square for en passant
+	std::uint64_t attack_maps[2];	// The board's attack maps, checking pieces and pinned pieces from before the move, so unmake_move can put them back
+	std::uint64_t check_pieces[2];	// without working them out again
+	std::uint64_t pinned[2];
+	std::uint64_t zobrist_key;		// The position key, side to move, castling rights and en passant column from before the move
+	std::uint8_t side_to_move;
+	std::uint8_t castling_rights;
+	std::int8_t en_passant_column;
+	std::uint16_t halfmove_clock;	// The halfmove clock from before the move
+	std::int16_t middle_game_score;	// The board's piece-square scores and game phase from before the move
+	std::int16_t end_game_score;
+	std::uint8_t game_phase;
+};
+
+const std::int8_t no_piece_taken = -1;
+const std::int8_t no_move_made = -2;
+
+#endif
@@ -0,0 +1,228 @@
+// evaluation.cpp implements the functions defined in the evaluation.h header file
+
+#include "evaluation.h"
+#include "board_and_players.h"
+#include "piece_attacks.h"
+
+namespace {
+	// Material of each piece type for the middle game and end game, indexed by piece_index (the king is on the board in every position so it is worth nothing)
+	constexpr int middle_game_material[number_of_piece_types] = { 82, 337, 365, 477, 1025, 0 };
+	constexpr int end_game_material[number_of_piece_types] = { 94, 281, 297, 512, 936, 0 };
+
+	// Square bonuses of each piece type for white, row 0 is rank 8 as on the board. Black's pieces use the square mirrored top to bottom (index ^ 56)
+	constexpr int middle_game_squares[number_of_piece_types][64] = {
+		{	  0,   0,   0,   0,   0,   0,   0,   0,		// pawn
+			 98, 134,  61,  95,  68, 126,  34, -11,
+			 -6,   7,  26,  31,  65,  56,  25, -20,
+			-14,  13,   6,  21,  23,  12,  17, -23,
+			-27,  -2,  -5,  12,  17,   6,  10, -25,
+			-26,  -4,  -4, -10,   3,   3,  33, -12,
+			-35,  -1, -20, -23, -15,  24,  38, -22,
+			  0,   0,   0,   0,   0,   0,   0,   0 },
+		{	-167, -89, -34, -49,  61, -97, -15,-107,		// knight
+			-73, -41,  72,  36,  23,  62,   7, -17,
+			-47,  60,  37,  65,  84, 129,  73,  44,
+			 -9,  17,  19,  53,  37,  69,  18,  22,
+			-13,   4,  16,  13,  28,  19,  21,  -8,
+			-23,  -9,  12,  10,  19,  17,  25, -16,
+			-29, -53, -12,  -3,  -1,  18, -14, -19,
+			-105, -21, -58, -33, -17, -28, -19, -23 },
+		{	-29,   4, -82, -37, -25, -42,   7,  -8,		// bishop
+			-26,  16, -18, -13,  30,  59,  18, -47,
+			-16,  37,  43,  40,  35,  50,  37,  -2,
+			 -4,   5,  19,  50,  37,  37,   7,  -2,
+			 -6,  13,  13,  26,  34,  12,  10,   4,
+			  0,  15,  15,  15,  14,  27,  18,  10,
+			  4,  15,  16,   0,   7,  21,  33,   1,
+			-33,  -3, -14, -21, -13, -12, -39, -21 },
+		{	 32,  42,  32,  51,  63,   9,  31,  43,		// rook
+			 27,  32,  58,  62,  80,  67,  26,  44,
+			 -5,  19,  26,  36,  17,  45,  61,  16,
+			-24, -11,   7,  26,  24,  35,  -8, -20,
+			-36, -26, -12,  -1,   9,  -7,   6, -23,
+			-45, -25, -16, -17,   3,   0,  -5, -33,
+			-44, -16, -20,  -9,  -1,  11,  -6, -71,
+			-19, -13,   1,  17,  16,   7, -37, -26 },
+		{	-28,   0,  29,  12,  59,  44,  43,  45,		// queen
+			-24, -39,  -5,   1, -16,  57,  28,  54,
+			-13, -17,   7,   8,  29,  56,  47,  57,
+			-27, -27, -16, -16,  -1,  17,  -2,   1,
+			 -9, -26,  -9, -10,  -2,  -4,   3,  -3,
+			-14,   2, -11,  -2,  -5,   2,  14,   5,
+			-35,  -8,  11,   2,   8,  15,  -3,   1,
+			 -1, -18,  -9,  10, -15, -25, -31, -50 },
+		{	-65,  23,  16, -15, -56, -34,   2,  13,		// king
+			 29,  -1, -20,  -7,  -8,  -4, -38, -29,
+			 -9,  24,   2, -16, -20,   6,  22, -22,
+			-17, -20, -12, -27, -30, -25, -14, -36,
+			-49,  -1, -27, -39, -46, -44, -33, -51,
+			-14, -14, -22, -46, -44, -30, -15, -27,
+			  1,   7,  -8, -64, -43, -16,   9,   8,
+			-15,  36,  12, -54,   8, -28,  24,  14 }
+	};
+	constexpr int end_game_squares[number_of_piece_types][64] = {
+		{	  0,   0,   0,   0,   0,   0,   0,   0,		// pawn
+			178, 173, 158, 134, 147, 132, 165, 187,
+			 94, 100,  85,  67,  56,  53,  82,  84,
+			 32,  24,  13,   5,  -2,   4,  17,  17,
+			 13,   9,  -3,  -7,  -7,  -8,   3,  -1,
+			  4,   7,  -6,   1,   0,  -5,  -1,  -8,
+			 13,   8,   8,  10,  13,   0,   2,  -7,
+			  0,   0,   0,   0,   0,   0,   0,   0 },
+		{	-58, -38, -13, -28, -31, -27, -63, -99,		// knight
+			-25,  -8, -25,  -2,  -9, -25, -24, -52,
+			-24, -20,  10,   9,  -1,  -9, -19, -41,
+			-17,   3,  22,  22,  22,  11,   8, -18,
+			-18,  -6,  16,  25,  16,  17,   4, -18,
+			-23,  -3,  -1,  15,  10,  -3, -20, -22,
+			-42, -20, -10,  -5,  -2, -20, -23, -44,
+			-29, -51, -23, -15, -22, -18, -50, -64 },
+		{	-14, -21, -11,  -8,  -7,  -9, -17, -24,		// bishop
+			 -8,  -4,   7, -12,  -3, -13,  -4, -14,
+			  2,  -8,   0,  -1,  -2,   6,   0,   4,
+			 -3,   9,  12,   9,  14,  10,   3,   2,
+			 -6,   3,  13,  19,   7,  10,  -3,  -9,
+			-12,  -3,   8,  10,  13,   3,  -7, -15,
+			-14, -18,  -7,  -1,   4,  -9, -15, -27,
+			-23,  -9, -23,  -5,  -9, -16,  -5, -17 },
+		{	 13,  10,  18,  15,  12,  12,   8,   5,		// rook
+			 11,  13,  13,  11,  -3,   3,   8,   3,
+			  7,   7,   7,   5,   4,  -3,  -5,  -3,
+			  4,   3,  13,   1,   2,   1,  -1,   2,
+			  3,   5,   8,   4,  -5,  -6,  -8, -11,
+			 -4,   0,  -5,  -1,  -7, -12,  -8, -16,
+			 -6,  -6,   0,   2,  -9,  -9, -11,  -3,
+			 -9,   2,   3,  -1,  -5, -13,   4, -20 },
+		{	 -9,  22,  22,  27,  27,  19,  10,  20,		// queen
+			-17,  20,  32,  41,  58,  25,  30,   0,
+			-20,   6,   9,  49,  47,  35,  19,   9,
+			  3,  22,  24,  45,  57,  40,  57,  36,
+			-18,  28,  19,  47,  31,  34,  39,  23,
+			-16, -27,  15,   6,   9,  17,  10,   5,
+			-22, -23, -30, -16, -16, -23, -36, -32,
+			-33, -28, -22, -43,  -5, -32, -20, -41 },
+		{	-74, -35, -18, -18, -11,  15,   4, -17,		// king
+			-12,  17,  14,  17,  17,  38,  23,  11,
+			 10,  17,  23,  15,  20,  45,  44,  13,
+			 -8,  22,  24,  27,  26,  33,  26,   3,
+			-18,  -4,  21,  24,  27,  23,   9, -11,
+			-19,  -3,  11,  21,  23,  16,   7,  -9,
+			-27, -11,   4,  13,  14,   4,  -5, -17,
+			-53, -34, -21, -11, -28, -14, -24, -43 }
+	};
+
+	// Function to build the table the board reads, adding the material to the square bonuses and mirroring them for black, when the program is compiled
+	constexpr piece_square_table make_piece_square_table()
+	{
+		piece_square_table table{};
+		for (int type = 0; type < number_of_piece_types; type++) {
+			for (int index = 0; index < 64; index++) {
+				table.middle_game[white][type][index] = std::int16_t(middle_game_material[type] + middle_game_squares[type][index]);
+				table.end_game[white][type][index] = std::int16_t(end_game_material[type] + end_game_squares[type][index]);
+				table.middle_game[black][type][index] = std::int16_t(-(middle_game_material[type] + middle_game_squares[type][index ^ 56]));
+				table.end_game[black][type][index] = std::int16_t(-(end_game_material[type] + end_game_squares[type][index ^ 56]));
+			}
+		}
+		return table;
+	}
+
+	// Mobility, the score for each square a piece can go to beyond the usual number for its type, for the middle and end game, indexed by piece_index.
+	// Squares held by the piece's own team or attacked by enemy pawns don't count
+	constexpr int middle_game_mobility[number_of_piece_types] = { 0, 4, 5, 2, 1, 0 };
+	constexpr int end_game_mobility[number_of_piece_types] = { 0, 4, 5, 4, 2, 0 };
+	constexpr int usual_mobility[number_of_piece_types] = { 0, 4, 7, 7, 14, 0 };
+
+	// King safety, how much an attack on one square around the king counts for each type of attacking piece, indexed by piece_index. The units of
+	// every attacker are added up and the king loses units squared / 4 in the middle game (up to max_king_danger), but only once two or more
+	// pieces join the attack since one piece on its own can rarely get through
+	constexpr int king_attack_units[number_of_piece_types] = { 0, 2, 2, 3, 5, 0 };
+	const int max_king_danger = 500;
+	const int shield_bonus[2] = { 12, 6 };		// Middle game bonus for each pawn one and two rows in front of a king on its back two rows (within a column of it)
+
+	const bitboard not_column_a = 0xfefefefefefefefeULL;
+	const bitboard not_column_h = 0x7f7f7f7f7f7f7f7fULL;
+
+	// Function to find every square attacked by the pawns of a team, white pawns attack towards row 0 and black pawns towards row 7
+	bitboard pawn_attack_squares(bitboard pawns, colour pawn_colour)
+	{
+		if (pawn_colour == white) return ((pawns & not_column_a) >> 9) | ((pawns & not_column_h) >> 7);
+		return ((pawns & not_column_a) << 7) | ((pawns & not_column_h) << 9);
+	}
+
+	// Function to add up the mobility and king safety of one team, for the middle game and end game, from that team's point of view
+	void attack_terms(const position &p, colour team_colour, int &middle_game, int &end_game)
+	{
+		colour enemy_colour = opposite_colour(team_colour);
+		bitboard occupied = p.occupancy();
+		bitboard safe_squares = ~p.team_occupancy[team_colour] & ~pawn_attack_squares(p.piece_sets[enemy_colour][pawn_index], enemy_colour);
+		bitboard enemy_king = p.piece_sets[enemy_colour][king_index];
+		bitboard king_zone = enemy_king != 0 ? king_attacks(lowest_square(enemy_king)) | enemy_king : 0;
+		int king_attackers = 0, attack_units = 0;
+
+		for (int type = knight_index; type <= queen_index; type++) {
+			bitboard pieces = p.piece_sets[team_colour][type];
+			while (pieces) {
+				bitboard attacked = piece_attacks(team_colour, piece_index(type), pop_lowest_square(pieces), occupied);
+				int moves = count_squares(attacked & safe_squares) - usual_mobility[type];
+				middle_game += middle_game_mobility[type] * moves;
+				end_game += end_game_mobility[type] * moves;
+				if (attacked & king_zone) {
+					king_attackers++;
+					attack_units += king_attack_units[type] * count_squares(attacked & king_zone);
+				}
+			}
+		}
+		if (king_attackers >= 2) { //the danger to the enemy king is a bonus for this team
+			int danger = attack_units * attack_units / 4;
+			middle_game += danger < max_king_danger ? danger : max_king_danger;
+		}
+
+		//pawns in front of the team's own king, while it is still on its back two rows
+		bitboard king = p.piece_sets[team_colour][king_index];
+		if (king == 0) return;
+		int king_square = lowest_square(king);
+		bool back_rows = team_colour == white ? index_row(king_square) >= 6 : index_row(king_square) <= 1;
+		if (back_rows == false) return;
+		bitboard columns = king | ((king & not_column_a) >> 1) | ((king & not_column_h) << 1);
+		bitboard pawns = p.piece_sets[team_colour][pawn_index];
+		bitboard first_row = team_colour == white ? columns >> 8 : columns << 8;
+		bitboard second_row = team_colour == white ? columns >> 16 : columns << 16;
+		middle_game += shield_bonus[0] * count_squares(pawns & first_row) + shield_bonus[1] * count_squares(pawns & second_row);
+	}
+}
+
+constexpr piece_square_table piece_square_values = make_piece_square_table();
+
+// [5]  Function to work out the piece-square score of a position from scratch by adding up the values of every piece. The board only does this when it is
+//      set up from a FEN or a stored position, every move updates the score without calling this
+
+piece_square_score score_position(const position &p)
+{
+	piece_square_score score;
+	score.clear();
+	for (int team = 0; team < 2; team++) {
+		for (int type = 0; type < number_of_piece_types; type++) {
+			bitboard pieces = p.piece_sets[team][type];
+			while (pieces) score.add_piece(colour(team), piece_index(type), pop_lowest_square(pieces));
+		}
+	}
+	return score;
+}
+
+// [6]  Function to score a position from the point of view of a team, in hundredths of a pawn. The material and piece-square part comes from the board's
+//      incrementally kept piece_square_score, the mobility and king safety of both teams are worked out from the attack tables and blended by the same
+//      game phase
+
+int evaluate(const board &chessboard, colour team_colour)
+{
+	const position &p = chessboard.get_position();
+	const piece_square_score &material = chessboard.piece_square();
+	int middle_game[2] = { 0, 0 }, end_game[2] = { 0, 0 };
+	attack_terms(p, white, middle_game[white], end_game[white]);
+	attack_terms(p, black, middle_game[black], end_game[black]);
+
+	int weight = material.phase < full_phase ? material.phase : full_phase;
+	int terms = ((middle_game[white] - middle_game[black]) * weight + (end_game[white] - end_game[black]) * (full_phase - weight)) / full_phase;
+	int score = material.tapered() + terms;
+	return team_colour == white ? score : -score;
+}
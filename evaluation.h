@@ -0,0 +1,57 @@
+// evaluation.h declares the evaluation, which scores a position in hundredths of a pawn for the search. Every piece is worth its material plus a bonus
+// for the square it stands on (a piece-square table), with one table for the middle game and one for the end game: a king should hide in the corner
+// while there are queens about but walk to the centre once they are gone. The two scores are blended by the game phase, which is worked out from the
+// pieces left on the board, so the evaluation moves smoothly from one table to the other as pieces are exchanged ("tapered" evaluation). The material
+// and piece-square scores of a position only change where a move puts a piece on or takes a piece off a square, so the board keeps them in a
+// piece_square_score which make_move updates in a few additions in the same way it updates the Zobrist key, and nothing has to look at every piece
+// to find them. On top of that, evaluate adds the terms which depend on how the pieces attack each other and so can't be kept up to date move by
+// move: mobility (the squares each knight, bishop, rook and queen can go to) and king safety (the enemy pieces attacking the squares around the king
+// and the pawns sheltering it). The tables are the PeSTO tables, laid out with bit index 0 at the top left (rank 8) like the board so white's pieces
+// read them directly and black's read them mirrored top to bottom
+
+#ifndef EVALUATION_H
+#define EVALUATION_H
+
+#include "bitboard.h"
+#include <cstdint>
+
+class board;
+
+const int full_phase = 24;																										// The game phase with every piece on the board, 0 is an end game of kings and pawns
+constexpr int phase_weights[number_of_piece_types] = { 0, 1, 1, 2, 4, 0 };														// How much each piece type counts towards the game phase, indexed by piece_index
+
+																																// PIECE_SQUARE_TABLE STRUCT
+struct piece_square_table {																										//--------------------------------------------------------------------------------------------------------
+	std::int16_t middle_game[2][number_of_piece_types][64];	// The material and square bonus of each piece of each team on each square, indexed by [colour][piece_index][bit index].
+	std::int16_t end_game[2][number_of_piece_types][64];	// Black's values are negative, so every score is from white's point of view and a position's score is a plain sum
+};
+
+extern const piece_square_table piece_square_values;
+
+																																// PIECE_SQUARE_SCORE STRUCT
+struct piece_square_score {																										//--------------------------------------------------------------------------------------------------------
+	std::int16_t middle_game;	// The sum of the middle game values of every piece on the board, white's pieces minus black's
+	std::int16_t end_game;		// The sum of the end game values
+	std::uint8_t phase;			// The sum of the phase weights of every piece on the board, full_phase at the start of a game (more after a promotion)
+
+	void clear() { middle_game = 0; end_game = 0; phase = 0; }																	// [1]  Function to empty the score of all pieces
+	void add_piece(colour piece_colour, piece_index type_index, int index) {													// [2]  Function to add the values of a piece put on a square
+		middle_game += piece_square_values.middle_game[piece_colour][type_index][index];
+		end_game += piece_square_values.end_game[piece_colour][type_index][index];
+		phase += std::uint8_t(phase_weights[type_index]);
+	}
+	void remove_piece(colour piece_colour, piece_index type_index, int index) {													// [3]  Function to take away the values of a piece taken off a square
+		middle_game -= piece_square_values.middle_game[piece_colour][type_index][index];
+		end_game -= piece_square_values.end_game[piece_colour][type_index][index];
+		phase -= std::uint8_t(phase_weights[type_index]);
+	}
+	int tapered() const {																										// [4]  Function to blend the middle and end game scores by the game phase, from white's point of view
+		int weight = phase < full_phase ? phase : full_phase;
+		return (middle_game * weight + end_game * (full_phase - weight)) / full_phase;
+	}
+};
+
+piece_square_score score_position(const position &p);																			// [5]  Function to work out the piece-square score of a position from scratch
+int evaluate(const board &chessboard, colour team_colour);																		// [6]  Function to score a position from the point of view of a team
+
+#endif
@@ -0,0 +1,72 @@
+// mapped_file.cpp implements the functions defined in the mapped_file.h header file
+
+#include "mapped_file.h"
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// [1]  Unparameterised mapped_file constructor, no file is open
+
+#if defined(_WIN32)
+mapped_file::mapped_file() : data{ nullptr }, length{ 0 }, file_handle{ INVALID_HANDLE_VALUE }, mapping_handle{ nullptr } {}
+#else
+mapped_file::mapped_file() : data{ nullptr }, length{ 0 }, file_descriptor{ -1 } {}
+#endif
+
+// [2]  Mapped_file destructor, unmaps and closes the file
+
+mapped_file::~mapped_file() { close(); }
+
+// [3]  Function to map a whole file for reading, returns false if it can't be opened. The file is read from start to end, so the operating system is told
+//      to read ahead and drop pages behind. An empty file is open but has no text, since a mapping can't be empty
+
+bool mapped_file::open(const char *file_name)
+{
+	close();
+#if defined(_WIN32)
+	file_handle = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file_handle == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(file_handle, &size) == 0) { close(); return false; }
+	length = std::size_t(size.QuadPart);
+	if (length == 0) return true;
+	mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping_handle == nullptr) { close(); return false; }
+	data = static_cast<const char *>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+	if (data == nullptr) { close(); return false; }
+#else
+	file_descriptor = ::open(file_name, O_RDONLY);
+	if (file_descriptor < 0) return false;
+	struct stat status;
+	if (fstat(file_descriptor, &status) != 0) { close(); return false; }
+	length = std::size_t(status.st_size);
+	if (length == 0) return true;
+	void *mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+	if (mapping == MAP_FAILED) { length = 0; close(); return false; }
+	madvise(mapping, length, MADV_SEQUENTIAL);
+	data = static_cast<const char *>(mapping);
+#endif
+	return true;
+}
+
+// [4]  Function to unmap and close the file
+
+void mapped_file::close()
+{
+#if defined(_WIN32)
+	if (data != nullptr) UnmapViewOfFile(data);
+	if (mapping_handle != nullptr) CloseHandle(mapping_handle);
+	if (file_handle != INVALID_HANDLE_VALUE) CloseHandle(file_handle);
+	mapping_handle = nullptr; file_handle = INVALID_HANDLE_VALUE;
+#else
+	if (data != nullptr) munmap(const_cast<char *>(data), length);
+	if (file_descriptor >= 0) ::close(file_descriptor);
+	file_descriptor = -1;
+#endif
+	data = nullptr; length = 0;
+}
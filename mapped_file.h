@@ -0,0 +1,33 @@
+// mapped_file.h declares the mapped_file class which memory maps a file for reading. The operating system pages the file in as it is read and drops the
+// pages again when memory is needed, so a file many times larger than the memory of the machine can be read as one block of characters without copying
+// it into the program's own memory, and the memory used stays the same whatever the size of the file
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string_view>
+
+																																// MAPPED_FILE CLASS
+class mapped_file {																												//--------------------------------------------------------------------------------------------------------
+private:
+	const char *data;		// The first character of the file, or nullptr if no file is open
+	std::size_t length;		// The size of the file in bytes
+#if defined(_WIN32)
+	void *file_handle;		// The Windows handles of the open file and of its mapping
+	void *mapping_handle;
+#else
+	int file_descriptor;	// The descriptor of the open file
+#endif
+public:
+	mapped_file();																												// [1]  Unparameterised mapped_file constructor, no file is open
+	~mapped_file();																												// [2]  Mapped_file destructor, unmaps and closes the file
+	mapped_file(const mapped_file &) = delete;
+	mapped_file &operator=(const mapped_file &) = delete;
+
+	bool open(const char *file_name);																							// [3]  Function to map a whole file for reading, returns false if it can't be opened
+	void close();																												// [4]  Function to unmap and close the file
+	std::string_view text() const { return std::string_view(data, length); }													// [5]  Function to access the contents of the file
+};
+
+#endif
@@ -0,0 +1,170 @@
+// move_picker.cpp implements the functions defined in the move_picker.h header file
+
+#include "move_picker.h"
+#include "piece_attacks.h"
+#include <algorithm>
+
+namespace {
+	// Function to find the value of the piece on a square in pawns, from the piece_type enum (pawn = 1 up to queen = 9 and king = 100)
+	int piece_value(const position &p, int index)
+	{
+		colour piece_colour; piece_index type;
+		if (p.find_piece(index, piece_colour, type) == false) return 0;
+		return to_piece_type(type);
+	}
+}
+
+// MOVE_PICKER FUNCTIONS
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// [1]  Function to check if a move neither takes a piece nor promotes. A pawn moving diagonally always takes, even onto an empty square (en passant)
+
+bool is_quiet(const board &chessboard, const chess_move &m)
+{
+	const position &p = chessboard.get_position();
+	if (m.promotion != no_promotion || p.is_occupied(m.to)) return false;
+	colour piece_colour; piece_index type;
+	return p.find_piece(m.from, piece_colour, type) == false || type != pawn_index || index_column(m.from) == index_column(m.to);
+}
+
+// [2]  Function to work out the material a capture wins (in hundredths of a pawn, from the piece_type values) once both teams have taken back on its square
+//      with every piece that attacks it, each team always taking with its least valuable piece and stopping when taking back would lose more. The attackers
+//      come from the attack tables with the pieces that have already taken removed from the occupied squares, so a rook or bishop behind another piece on
+//      the same line joins in once the piece in front of it has taken (an x-ray attack). Pins are ignored, a pinned piece is counted as if it could take
+
+int static_exchange(const board &chessboard, const chess_move &m)
+{
+	const position &p = chessboard.get_position();
+	colour moving_colour; piece_index moving_type;
+	if (p.find_piece(m.from, moving_colour, moving_type) == false) return 0;
+	auto value = [](int type) { return 100 * int(to_piece_type(type)); };
+
+	int gain[32];
+	int depth = 0;
+	bitboard occupied = p.occupancy() ^ square_bit(m.from);
+	gain[0] = p.is_occupied(m.to) ? value(code_type(p.piece_codes[m.to])) : 0;
+	if (moving_type == pawn_index && p.is_occupied(m.to) == false && index_column(m.from) != index_column(m.to)) { //en passant
+		gain[0] = value(pawn_index);
+		occupied ^= square_bit(square_index(index_row(m.from), index_column(m.to)));
+	}
+	int on_square = moving_type; //the type of the piece standing on the square, which the next capture takes
+	if (m.promotion != no_promotion) { gain[0] += value(m.promotion) - value(pawn_index); on_square = m.promotion; }
+
+	const bitboard diagonal_sliders = p.piece_sets[white][bishop_index] | p.piece_sets[black][bishop_index] | p.piece_sets[white][queen_index] | p.piece_sets[black][queen_index];
+	const bitboard straight_sliders = p.piece_sets[white][rook_index] | p.piece_sets[black][rook_index] | p.piece_sets[white][queen_index] | p.piece_sets[black][queen_index];
+	bitboard attackers = (attackers_to(p, m.to, white, occupied) | attackers_to(p, m.to, black, occupied)) & occupied;
+	colour side = opposite_colour(moving_colour);
+	for (;;) {
+		bitboard side_attackers = attackers & p.team_occupancy[side];
+		if (side_attackers == 0 || depth >= 31) break;
+		int type = pawn_index;
+		while ((side_attackers & p.piece_sets[side][type]) == 0) type++; //the least valuable attacker
+		//the king can only take if the other team has nothing left to take back with
+		if (type == king_index && (attackers & p.team_occupancy[opposite_colour(side)] & occupied) != 0) break;
+		depth++;
+		gain[depth] = value(on_square) - gain[depth - 1]; //the score for this side if it takes and the other side then stops
+		if (std::max(-gain[depth - 1], gain[depth]) < 0) break; //neither taking nor stopping can help this side, so the sequence ends here either way
+
+		occupied ^= square_bit(lowest_square(side_attackers & p.piece_sets[side][type]));
+		attackers |= (bishop_attacks(m.to, occupied) & diagonal_sliders) | (rook_attacks(m.to, occupied) & straight_sliders); //pieces uncovered behind it
+		attackers &= occupied;
+		on_square = type;
+		side = opposite_colour(side);
+	}
+	for (; depth > 0; depth--) gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]); //each side picks the better of taking and stopping, from the end back
+	return gain[0];
+}
+
+
+// MOVE_PICKER CLASS
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// [3]  Function to take the highest scoring move left in the current stage. The best move is swapped to the front of what is left, so only as much of the
+//      list is sorted as the search uses
+
+bool move_picker::pick_best(chess_move &m) {
+	if (next >= moves.size()) return false;
+	int best = next;
+	for (int i = next + 1; i < moves.size(); i++) if (scores[i] > scores[best]) best = i;
+	moves.swap(next, best);
+	int score = scores[next]; scores[next] = scores[best]; scores[best] = score;
+	m = moves[next++];
+	return true;
+}
+
+// [4]  Function to check if a move was already handed out by the hash or killer stage, so the generated stages don't hand it out twice
+
+bool move_picker::already_tried(const chess_move &m) const {
+	return m == hash_move || (stage == quiet_stage && (m == killers[0] || m == killers[1]));
+}
+
+// [5]  Parameterised move_picker constructor, the hash move and killer moves may be empty (0 to 0) or moves of another position, they are checked before
+//      they are handed out. With captures_only set the picker stops after the captures and promotions
+
+move_picker::move_picker(const board &position_board, colour team, chess_move first_move, const chess_move *killer_moves, const history_table *team_history,
+	bool captures_only)
+	: chessboard{ position_board }, team_colour{ team }, hash_move{ first_move }, history{ team_history }, noisy_only{ captures_only }, stage{ hash_stage },
+	killer_number{ 0 }, next{ 0 } {
+	if (noisy_only == true && pack_move(hash_move) != 0 && is_quiet(chessboard, hash_move) == true) hash_move = chess_move(0, 0);
+	killers[0] = killer_moves != nullptr ? killer_moves[0] : chess_move(0, 0);
+	killers[1] = killer_moves != nullptr ? killer_moves[1] : chess_move(0, 0);
+}
+
+// [6]  Function to find the next legal move, returns false once every move has been handed out. Each generated move is checked for king safety only when it
+//      is reached, so the moves after a cut off are never checked
+
+bool move_picker::next_move(chess_move &m) {
+	const position &p = chessboard.get_position();
+	for (;;) {
+		switch (stage) {
+		case hash_stage:
+			stage = generate_noisy_stage;
+			if (pack_move(hash_move) != 0 && chessboard.is_pseudo_legal(team_colour, hash_move) && chessboard.leaves_king_safe(team_colour, hash_move)) {
+				m = hash_move;
+				return true;
+			}
+			hash_move = chess_move(0, 0);
+			break;
+
+		case generate_noisy_stage: //MVV-LVA, taking the most valuable piece first and with the least valuable piece when there is a choice, promotions add the new piece
+			chessboard.generate_moves(team_colour, moves, noisy_moves);
+			for (int i = 0; i < moves.size(); i++) {
+				int victim = p.is_occupied(moves[i].to) ? piece_value(p, moves[i].to) : (moves[i].promotion == no_promotion ? int(pawn) : 0); //an empty square is en passant
+				int promotion = moves[i].promotion != no_promotion ? int(to_piece_type(moves[i].promotion)) : 0;
+				scores[i] = 1000 * (victim + promotion) - piece_value(p, moves[i].from);
+			}
+			next = 0; stage = noisy_stage;
+			break;
+
+		case noisy_stage:
+			while (pick_best(m) == true) {
+				if (already_tried(m) == false && chessboard.leaves_king_safe(team_colour, m) == true) return true;
+			}
+			stage = noisy_only ? finished_stage : killer_stage;
+			break;
+
+		case killer_stage:
+			while (killer_number < 2) {
+				m = killers[killer_number++];
+				if (pack_move(m) == 0 || m == hash_move || (killer_number == 2 && m == killers[0]) || is_quiet(chessboard, m) == false) continue;
+				if (chessboard.is_pseudo_legal(team_colour, m) && chessboard.leaves_king_safe(team_colour, m)) return true;
+			}
+			stage = generate_quiet_stage;
+			break;
+
+		case generate_quiet_stage:
+			chessboard.generate_moves(team_colour, moves, quiet_moves);
+			for (int i = 0; i < moves.size(); i++) scores[i] = history != nullptr ? (*history)[moves[i].from][moves[i].to] : 0;
+			next = 0; stage = quiet_stage;
+			break;
+
+		case quiet_stage:
+			while (pick_best(m) == true) {
+				if (already_tried(m) == false && chessboard.leaves_king_safe(team_colour, m) == true) return true;
+			}
+			stage = finished_stage;
+			break;
+
+		default:
+			return false;
+		}
+	}
+}
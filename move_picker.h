@@ -0,0 +1,46 @@
+// move_picker.h declares the move_picker class which hands the moves of a position to the search one at a time, best first. Alpha-beta search cuts off
+// as soon as a move scores beta or more, so the earlier a good move is searched the fewer moves are searched at all. The moves come in stages: first the
+// move from the transposition table, then the captures and promotions ordered by MVV-LVA (most valuable victim, least valuable attacker, using the values
+// of the piece_type enum), then the two killer moves (quiet moves which caused a cut off at the same ply of the search elsewhere in the tree), then the
+// other quiet moves ordered by the history table (how often each move has caused a cut off anywhere in the search). Each stage is only generated when the
+// stage before it runs out, so when the hash move or a capture cuts off, the quiet moves are never generated at all. Only legal moves are handed out.
+// The quiescence search asks for the captures and promotions alone. static_exchange works out what a capture wins or loses once every piece attacking
+// its square has joined in, so the quiescence search can leave out the captures that lose material
+
+#ifndef MOVE_PICKER_H
+#define MOVE_PICKER_H
+
+#include "board_and_players.h"
+
+typedef int history_table[64][64];		// A score for every start and end square of one team's moves, higher for moves that have caused more cut offs
+
+bool is_quiet(const board &chessboard, const chess_move &m);																	// [1]  Function to check if a move neither takes a piece nor promotes
+int static_exchange(const board &chessboard, const chess_move &m);																// [2]  Function to work out the material a capture wins once both teams have taken back on its square
+
+																																// MOVE_PICKER CLASS
+class move_picker {																												//--------------------------------------------------------------------------------------------------------
+private:
+	enum pick_stage { hash_stage, generate_noisy_stage, noisy_stage, killer_stage, generate_quiet_stage, quiet_stage, finished_stage };
+
+	const board &chessboard;
+	colour team_colour;
+	chess_move hash_move;					// The move from the transposition table or the last principal variation, searched first
+	chess_move killers[2];					// The killer moves of this ply
+	const history_table *history;			// The history table of the team to move, or nullptr to leave the quiet moves in the order they were generated
+	bool noisy_only;						// Set to hand out only the captures and promotions (and the hash move if it is one)
+	int stage;
+	int killer_number;						// The next killer move to try
+	move_list moves;						// The moves of the current stage
+	int scores[move_list::capacity];		// The score of each move in moves, the best remaining move is picked by a selection sort
+	int next;								// The index in moves of the next move to hand out
+
+	bool pick_best(chess_move &m);																								// [3]  Function to take the highest scoring move left in the current stage
+	bool already_tried(const chess_move &m) const;																				// [4]  Function to check if a move was already handed out by the hash or killer stage
+public:
+	move_picker(const board &position_board, colour team, chess_move first_move, const chess_move *killer_moves,				// [5]  Parameterised move_picker constructor
+		const history_table *team_history, bool captures_only = false);
+
+	bool next_move(chess_move &m);																								// [6]  Function to find the next legal move, returns false once every move has been handed out
+};
+
+#endif
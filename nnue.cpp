@@ -0,0 +1,247 @@
+// nnue.cpp implements the functions defined in the nnue.h header file
+
+#include "nnue.h"
+#include "piece_attacks.h"
+#include "zobrist.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+	// Function to find the input number of a piece on a square seen from one team's side, from black's side the square is mirrored top to bottom and
+	// black's pieces count as "ours"
+	int feature_index(colour side, colour piece_colour, piece_index type_index, int index)
+	{
+		int relative_colour = piece_colour == side ? 0 : 1;
+		int relative_square = side == white ? index : index ^ 56;
+		return (relative_colour * number_of_piece_types + type_index) * 64 + relative_square;
+	}
+
+	// Function to work out one side of an accumulator as the side before it plus some weight rows and minus others, going through the values a register
+	// at a time so each value is loaded and stored once however many rows change. before and after may be the same
+	void apply_rows(const std::int16_t *before, std::int16_t *after, const std::int16_t *const *added, int number_added,
+		const std::int16_t *const *removed, int number_removed)
+	{
+#if defined(__AVX2__)
+		for (int i = 0; i < nnue_hidden; i += 16) {
+			__m256i sum = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(before + i));
+			for (int row = 0; row < number_added; row++) sum = _mm256_add_epi16(sum, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(added[row] + i)));
+			for (int row = 0; row < number_removed; row++) sum = _mm256_sub_epi16(sum, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(removed[row] + i)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(after + i), sum);
+		}
+#elif defined(__SSE2__)
+		for (int i = 0; i < nnue_hidden; i += 8) {
+			__m128i sum = _mm_loadu_si128(reinterpret_cast<const __m128i *>(before + i));
+			for (int row = 0; row < number_added; row++) sum = _mm_add_epi16(sum, _mm_loadu_si128(reinterpret_cast<const __m128i *>(added[row] + i)));
+			for (int row = 0; row < number_removed; row++) sum = _mm_sub_epi16(sum, _mm_loadu_si128(reinterpret_cast<const __m128i *>(removed[row] + i)));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(after + i), sum);
+		}
+#else
+		for (int i = 0; i < nnue_hidden; i++) {
+			int sum = before[i];
+			for (int row = 0; row < number_added; row++) sum += added[row][i];
+			for (int row = 0; row < number_removed; row++) sum -= removed[row][i];
+			after[i] = std::int16_t(sum); //wraps the same way the 16 bit vector instructions do
+		}
+#endif
+	}
+
+	// Function to clip a row of values to [0, nnue_clip], giving the inputs of the next layer. The number of values is a multiple of 16
+	void clip_values(const std::int16_t *values, std::int16_t *clipped, int count)
+	{
+#if defined(__AVX2__)
+		const __m256i zero = _mm256_setzero_si256(), clip = _mm256_set1_epi16(nnue_clip);
+		for (int i = 0; i < count; i += 16) {
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(clipped + i), _mm256_min_epi16(_mm256_max_epi16(v, zero), clip));
+		}
+#elif defined(__SSE2__)
+		const __m128i zero = _mm_setzero_si128(), clip = _mm_set1_epi16(nnue_clip);
+		for (int i = 0; i < count; i += 8) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(clipped + i), _mm_min_epi16(_mm_max_epi16(v, zero), clip));
+		}
+#else
+		for (int i = 0; i < count; i++) clipped[i] = values[i] < 0 ? 0 : (values[i] > nnue_clip ? std::int16_t(nnue_clip) : values[i]);
+#endif
+	}
+
+	// Function to take the dot product of a row of clipped values and a row of weights in 32 bits. The number of values is a multiple of 16
+	std::int32_t dot_product(const std::int16_t *values, const std::int16_t *weights, int count)
+	{
+#if defined(__AVX2__)
+		__m256i sum = _mm256_setzero_si256();
+		for (int i = 0; i < count; i += 16) { //pairs multiplied and added into 32 bits
+			sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i)), _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i))));
+		}
+		__m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+		half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4e));
+		half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xb1));
+		return _mm_cvtsi128_si32(half);
+#elif defined(__SSE2__)
+		__m128i sum = _mm_setzero_si128();
+		for (int i = 0; i < count; i += 8) {
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i)), _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + i))));
+		}
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+		return _mm_cvtsi128_si32(sum);
+#else
+		std::int32_t sum = 0;
+		for (int i = 0; i < count; i++) sum += values[i] * weights[i];
+		return sum;
+#endif
+	}
+
+	// Function to take the dot products of a row of clipped values with four rows of weights at once (each row count long, one after the other), so each
+	// value is loaded once for four neurons and the four sums are added across their registers together. The number of values is a multiple of 16
+	void four_dot_products(const std::int16_t *values, const std::int16_t *weights, int count, std::int32_t *sums)
+	{
+#if defined(__AVX2__)
+		__m256i sum[4] = { _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256() };
+		for (int i = 0; i < count; i += 16) {
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+			for (int row = 0; row < 4; row++) sum[row] = _mm256_add_epi32(sum[row], _mm256_madd_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + row * count + i))));
+		}
+		__m256i pairs = _mm256_hadd_epi32(_mm256_hadd_epi32(sum[0], sum[1]), _mm256_hadd_epi32(sum[2], sum[3]));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(sums), _mm_add_epi32(_mm256_castsi256_si128(pairs), _mm256_extracti128_si256(pairs, 1)));
+#elif defined(__SSE2__)
+		__m128i sum[4] = { _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128() };
+		for (int i = 0; i < count; i += 8) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+			for (int row = 0; row < 4; row++) sum[row] = _mm_add_epi32(sum[row], _mm_madd_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + row * count + i))));
+		}
+		__m128i first = _mm_add_epi32(_mm_unpacklo_epi32(sum[0], sum[1]), _mm_unpackhi_epi32(sum[0], sum[1])); //SSE2 has no horizontal add, so transpose
+		__m128i second = _mm_add_epi32(_mm_unpacklo_epi32(sum[2], sum[3]), _mm_unpackhi_epi32(sum[2], sum[3]));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(sums), _mm_add_epi32(_mm_unpacklo_epi64(first, second), _mm_unpackhi_epi64(first, second)));
+#else
+		for (int row = 0; row < 4; row++) sums[row] = dot_product(values, weights + row * count, count);
+#endif
+	}
+
+	// Functions to read little endian numbers from the bytes of a weights file
+	std::uint32_t read_u32(const unsigned char *bytes) { return std::uint32_t(bytes[0]) | std::uint32_t(bytes[1]) << 8 | std::uint32_t(bytes[2]) << 16 | std::uint32_t(bytes[3]) << 24; }
+	std::int16_t read_i16(const unsigned char *bytes) { return std::int16_t(std::uint16_t(bytes[0] | bytes[1] << 8)); }
+
+	const int nnue_layer_shift = 6;		// Dividing by nnue_layer_scale
+	static_assert(1 << nnue_layer_shift == nnue_layer_scale, "the small hidden layer divides its sums with a shift");
+	static_assert(nnue_hidden % 16 == 0 && nnue_second_layer % 16 == 0, "the vector loops take 16 values at a time");
+}
+
+
+// NNUE_NETWORK CLASS
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// [1]  Function to add the first layer weights of a piece on a square to both sides of an accumulator
+
+void nnue_network::add_feature(nnue_accumulator &accumulator, colour piece_colour, piece_index type_index, int index) const {
+	for (int side = 0; side < 2; side++) {
+		const std::int16_t *row = &feature_weights[std::size_t(feature_index(colour(side), piece_colour, type_index, index)) * nnue_hidden];
+		apply_rows(accumulator.values[side], accumulator.values[side], &row, 1, nullptr, 0);
+	}
+}
+
+// [2]  Unparameterised nnue_network constructor, every weight starts at 0 so the network scores every position as level until weights are loaded
+
+nnue_network::nnue_network()
+	: feature_weights(std::size_t(nnue_inputs) * nnue_hidden, 0), feature_biases(nnue_hidden, 0), layer_weights(std::size_t(nnue_second_layer) * 2 * nnue_hidden, 0),
+	layer_biases(nnue_second_layer, 0), output_weights(nnue_second_layer, 0), output_bias{ 0 } {}
+
+// [3]  Function to read the weights from a file in the format described in nnue.h, returns false if the file can't be opened, isn't a weights file, was
+//      made for a different hidden layer size or is the wrong length. The weights are only replaced once the whole file has been checked
+
+bool nnue_network::load(const char *file_name) {
+	std::ifstream file(file_name, std::ios::binary);
+	if (!file) return false;
+	std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	const std::size_t expected = 16 + 2 * (std::size_t(nnue_inputs) * nnue_hidden + nnue_hidden + std::size_t(nnue_second_layer) * 2 * nnue_hidden)
+		+ 4 * nnue_second_layer + 2 * nnue_second_layer + 4;
+	if (bytes.size() != expected || std::memcmp(bytes.data(), "CHESSNNU", 8) != 0) return false;
+	if (read_u32(&bytes[8]) != nnue_version || read_u32(&bytes[12]) != std::uint32_t(nnue_hidden)) return false;
+
+	const unsigned char *next = &bytes[16];
+	for (std::int16_t &weight : feature_weights) { weight = read_i16(next); next += 2; }
+	for (std::int16_t &bias : feature_biases) { bias = read_i16(next); next += 2; }
+	for (std::int16_t &weight : layer_weights) { weight = read_i16(next); next += 2; }
+	for (std::int32_t &bias : layer_biases) { bias = std::int32_t(read_u32(next)); next += 4; }
+	for (std::int16_t &weight : output_weights) { weight = read_i16(next); next += 2; }
+	output_bias = std::int32_t(read_u32(next));
+	return true;
+}
+
+// [4]  Function to fill the weights with small random numbers from a seed (using the same random sequence as the Zobrist keys). The scores mean nothing,
+//      but a random network takes exactly as long to run as a trained one and changes with every piece, so it is enough for the benchmark and for checking
+//      that incremental updates match a full refresh. The first layer weights are kept small enough that no accumulator can overflow, and the second
+//      layer weights small enough that its neurons aren't all clipped
+
+void nnue_network::randomise(std::uint64_t seed) {
+	for (std::int16_t &weight : feature_weights) weight = std::int16_t(int(next_random(seed) % 129) - 64);
+	for (std::int16_t &bias : feature_biases) bias = std::int16_t(int(next_random(seed) % 129) - 64);
+	for (std::int16_t &weight : layer_weights) weight = std::int16_t(int(next_random(seed) % 9) - 4);
+	for (std::int32_t &bias : layer_biases) bias = std::int32_t(next_random(seed) % 16001) - 8000;
+	for (std::int16_t &weight : output_weights) weight = std::int16_t(int(next_random(seed) % 65) - 32);
+	output_bias = std::int32_t(next_random(seed) % 1001) - 500;
+}
+
+// [5]  Function to work out an accumulator from every piece of a position, the biases plus the weights of every piece. The search does this once for the
+//      position it starts from and updates the accumulator for every move after that
+
+void nnue_network::refresh(const position &p, nnue_accumulator &accumulator) const {
+	for (int side = 0; side < 2; side++) std::memcpy(accumulator.values[side], feature_biases.data(), sizeof(accumulator.values[side]));
+	for (int team = 0; team < 2; team++) {
+		for (int type = 0; type < number_of_piece_types; type++) {
+			bitboard pieces = p.piece_sets[team][type];
+			while (pieces) add_feature(accumulator, colour(team), piece_index(type), pop_lowest_square(pieces));
+		}
+	}
+}
+
+// [6]  Function to work out the accumulator after a move from the one before it. The undo record says which piece moved where, what it promoted to and
+//      what it took from which square, and the position (after the move) gives the team and type of the moved piece, so at most two rows are added and
+//      two taken away on each side: the moved piece, a taken piece, and the rook when castling
+
+void nnue_network::update(const nnue_accumulator &before, nnue_accumulator &after, const move_undo &undo, const position &p) const {
+	if (undo.taken_piece == no_move_made) { after = before; return; } //make_move had no piece to move and changed nothing
+	colour moving_colour; piece_index placed_type;
+	p.find_piece(undo.move.to, moving_colour, placed_type);
+	piece_index moving_type = undo.move.promotion != no_promotion ? pawn_index : placed_type;
+	bool castling = placed_type == king_index && (undo.move.to - undo.move.from == 2 || undo.move.from - undo.move.to == 2);
+	int rook_from = undo.move.to > undo.move.from ? undo.move.from + 3 : undo.move.from - 4, rook_to = (undo.move.from + undo.move.to) / 2;
+
+	for (int side = 0; side < 2; side++) {
+		auto row = [&](colour piece_colour, piece_index type_index, int index) {
+			return &feature_weights[std::size_t(feature_index(colour(side), piece_colour, type_index, index)) * nnue_hidden];
+		};
+		const std::int16_t *added[2], *removed[2];
+		int number_added = 0, number_removed = 0;
+		added[number_added++] = row(moving_colour, placed_type, undo.move.to);
+		removed[number_removed++] = row(moving_colour, moving_type, undo.move.from);
+		if (undo.taken_piece != no_piece_taken) removed[number_removed++] = row(opposite_colour(moving_colour), piece_index(undo.taken_piece), undo.taken_square);
+		else if (castling == true) {
+			added[number_added++] = row(moving_colour, rook_index, rook_to);
+			removed[number_removed++] = row(moving_colour, rook_index, rook_from);
+		}
+		apply_rows(before.values[side], after.values[side], added, number_added, removed, number_removed);
+	}
+}
+
+// [7]  Function to score a position from its accumulator for the team to move, in hundredths of a pawn. The team to move's side of the accumulator comes
+//      first in the inputs of the small hidden layer and the other team's side second, so the network knows whose turn it is. Each neuron's sum is divided
+//      by nnue_layer_scale (as a shift, the same on every path) and clipped, then the output neuron takes the dot product of the clipped neurons
+
+int nnue_network::evaluate(const nnue_accumulator &accumulator, colour team_colour) const {
+	alignas(32) std::int16_t inputs[2 * nnue_hidden];
+	alignas(32) std::int16_t neurons[nnue_second_layer];
+	clip_values(accumulator.values[team_colour], inputs, nnue_hidden);
+	clip_values(accumulator.values[opposite_colour(team_colour)], inputs + nnue_hidden, nnue_hidden);
+	std::int32_t sums[nnue_second_layer];
+	for (int neuron = 0; neuron < nnue_second_layer; neuron += 4) four_dot_products(inputs, &layer_weights[std::size_t(neuron) * 2 * nnue_hidden], 2 * nnue_hidden, sums + neuron);
+	for (int neuron = 0; neuron < nnue_second_layer; neuron++) {
+		std::int32_t sum = (sums[neuron] + layer_biases[neuron]) >> nnue_layer_shift;
+		neurons[neuron] = std::int16_t(sum < 0 ? 0 : (sum > nnue_clip ? nnue_clip : sum));
+	}
+	std::int32_t output = dot_product(neurons, output_weights.data(), nnue_second_layer) + output_bias;
+	return int(std::int64_t(output) * nnue_eval_scale / (nnue_clip * nnue_output_scale));
+}
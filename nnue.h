@@ -0,0 +1,65 @@
+// nnue.h declares an efficiently updatable neural network (NNUE) evaluation, which the search can use in place of the hand written evaluation in
+// evaluation.h. The network's inputs are one feature for each piece type of each team on each square (768 in all), seen from each team's side of the
+// board: from black's side the board is mirrored top to bottom and the teams are swapped, so both teams see their own pieces as "ours". The first layer
+// multiplies the inputs by its weights to give nnue_hidden numbers for each side, and since only a few inputs change with a move (a piece leaving one
+// square and arriving on another, a piece taken, a rook moved by castling) those numbers are kept in an accumulator and updated by adding and subtracting
+// a few weight rows rather than worked out from every piece. The accumulators are int16 so a 256 bit register holds sixteen of them. The two
+// accumulators are clipped to [0, nnue_clip] and put side by side (the team to move's first) as the 2 * nnue_hidden inputs of a small hidden layer of
+// nnue_second_layer neurons, whose outputs are clipped the same way and feed the single output neuron. Only the accumulators are kept up to date, the
+// two small layers are worked out in full for every evaluation.
+//
+// The accumulator updates and the dot products of the small layers use AVX2 intrinsics when the compiler targets a processor with AVX2, SSE2 otherwise (every x86-64
+// processor has it), and plain loops on any other processor. Every path gives exactly the same numbers.
+//
+// A weights file is a 16 byte header ("CHESSNNU", a version number and the hidden layer size, each number 4 bytes little endian), then the first layer
+// weights as int16 [768][nnue_hidden], the first layer biases as int16 [nnue_hidden], the second layer weights as int16 [nnue_second_layer][2 * nnue_hidden],
+// the second layer biases as int32 [nnue_second_layer], the output weights as int16 [nnue_second_layer] and the output bias as an int32, all little endian.
+// The weights are quantised: the first layer by nnue_clip, the second layer by nnue_layer_scale (its sums are divided by it, so its outputs are on the
+// same [0, nnue_clip] scale as its inputs) and the output layer by nnue_output_scale, so the score in hundredths of a pawn is
+// (output * nnue_eval_scale) / (nnue_clip * nnue_output_scale). The biases are quantised by the product of their layer's scale and nnue_clip
+
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "bitboard.h"
+#include "chess_move.h"
+#include <cstdint>
+#include <vector>
+
+const int nnue_inputs = 2 * number_of_piece_types * 64;		// One input for each piece type of each team on each square
+const int nnue_hidden = 256;								// The number of accumulator values for each side
+const int nnue_clip = 255;									// The first layer quantisation, accumulator values are clipped to [0, nnue_clip]
+const int nnue_second_layer = 32;							// The number of neurons in the small hidden layer
+const int nnue_layer_scale = 64;							// The small hidden layer quantisation
+const int nnue_output_scale = 64;							// The output layer quantisation
+const int nnue_eval_scale = 400;							// The network output (after removing the quantisation) times this is the score in hundredths of a pawn
+const std::uint32_t nnue_version = 2;
+
+																																// NNUE_ACCUMULATOR STRUCT
+struct nnue_accumulator {																										//--------------------------------------------------------------------------------------------------------
+	alignas(32) std::int16_t values[2][nnue_hidden];	// The first layer output seen from each team's side, indexed by [colour]
+};
+
+																																// NNUE_NETWORK CLASS
+class nnue_network																												//--------------------------------------------------------------------------------------------------------
+{
+private:
+	std::vector<std::int16_t> feature_weights;		// The first layer weights, nnue_hidden for each input
+	std::vector<std::int16_t> feature_biases;		// The first layer biases
+	std::vector<std::int16_t> layer_weights;		// The small hidden layer weights, 2 * nnue_hidden for each neuron: the team to move's accumulator then the other team's
+	std::vector<std::int32_t> layer_biases;
+	std::vector<std::int16_t> output_weights;		// The output weights, one for each neuron of the small hidden layer
+	std::int32_t output_bias;
+
+	void add_feature(nnue_accumulator &accumulator, colour piece_colour, piece_index type_index, int index) const;				// [1]  Function to add the first layer weights of a piece on a square to both sides of an accumulator
+
+public:
+	nnue_network();																												// [2]  Unparameterised nnue_network constructor, every weight starts at 0
+	bool load(const char *file_name);																							// [3]  Function to read the weights from a file, returns false (keeping the old weights) if it can't be read
+	void randomise(std::uint64_t seed);																							// [4]  Function to fill the weights with small random numbers, for measuring speed and checking updates without a trained file
+	void refresh(const position &p, nnue_accumulator &accumulator) const;														// [5]  Function to work out an accumulator from every piece of a position
+	void update(const nnue_accumulator &before, nnue_accumulator &after, const move_undo &undo, const position &p) const;		// [6]  Function to work out the accumulator after a move from the one before it, given the move's undo record
+	int evaluate(const nnue_accumulator &accumulator, colour team_colour) const;												// [7]  Function to score a position from its accumulator for the team to move, in hundredths of a pawn
+};
+
+#endif
@@ -0,0 +1,200 @@
+// perft.cpp is a benchmark and correctness harness for the move generator. Perft ("performance test") makes every legal move to a fixed depth and counts
+// the positions reached at the last move (the leaf nodes). These counts are known for standard positions, so any difference shows a bug in the rules, and
+// the time taken gives the speed of the move generator in nodes per second
+//
+// Usage:	perft							run the reference suite and compare every count with its known value
+//			perft <depth>					divide from the start position, printing the count below each first move
+//			perft fen "<FEN>" <depth>		divide from a position given in Forsyth-Edwards Notation
+//			perft validate <depth> ["<FEN>"]	check at every node down to <depth> that the move generator agrees with board::valid_board_move
+//											and that the incrementally updated Zobrist key matches the key worked out from scratch
+//											and that every position reads back the same from its FEN
+//											and that board::has_legal_move agrees with the number of legal moves
+
+#include "board_and_players.h"
+#include "piece_attacks.h"
+#include "zobrist.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace {
+	// A position of the reference suite with its known perft counts, expected[d - 1] is the count at depth d and 0 marks the end of the list
+	struct perft_test {
+		const char *name;
+		const char *fen;
+		unsigned long long expected[8];
+	};
+
+	// The standard perft positions, between them they cover castling on both sides (and through and out of check), en passant (including the pawn
+	// taken en passant uncovering an attack on the king along its row), promotion to every piece and taking with a promotion
+	const perft_test reference_suite[] = {
+		{ "Start position", start_fen, { 20ULL, 400ULL, 8902ULL, 197281ULL, 4865609ULL, 0ULL } },
+		{ "Kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", { 48ULL, 2039ULL, 97862ULL, 4085603ULL, 0ULL } },
+		{ "Position 3 (en passant and rook endings)", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", { 14ULL, 191ULL, 2812ULL, 43238ULL, 674624ULL, 0ULL } },
+		{ "Position 4 (promotions)", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", { 6ULL, 264ULL, 9467ULL, 422333ULL, 0ULL } },
+		{ "Position 4 mirrored", "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1", { 6ULL, 264ULL, 9467ULL, 422333ULL, 0ULL } },
+		{ "Position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", { 44ULL, 1486ULL, 62379ULL, 2103487ULL, 0ULL } },
+		{ "Position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", { 46ULL, 2079ULL, 89890ULL, 3894594ULL, 0ULL } },
+	};
+
+	double seconds_since(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void print_speed(unsigned long long nodes, double seconds)
+	{
+		std::cout << std::fixed << std::setprecision(3) << seconds << " s   ";
+		if (seconds > 0) std::cout << std::setprecision(2) << nodes / seconds / 1e6 << " Mnodes/s";
+		std::cout << std::endl;
+	}
+}
+
+// [1]  Function to count the leaf nodes below a position, each move is made and unmade in place. At depth 1 the number of legal moves is the count, so
+//      the last row of moves never needs to be made
+
+unsigned long long perft(board &chessboard, colour team_colour, int depth)
+{
+	move_list moves;
+	chessboard.generate_legal_moves(team_colour, moves);
+	if (depth <= 1) return depth == 1 ? moves.size() : 1;
+
+	unsigned long long nodes = 0;
+	for (const chess_move &m : moves) {
+		move_undo undo = chessboard.make_move(m);
+		nodes += perft(chessboard, opposite_colour(team_colour), depth - 1);
+		chessboard.unmake_move(undo);
+	}
+	return nodes;
+}
+
+// [2]  Function to print the count below each first move, which narrows a wrong total down to the move whose count is wrong
+
+unsigned long long divide(board &chessboard, colour team_colour, int depth)
+{
+	move_list moves;
+	chessboard.generate_legal_moves(team_colour, moves);
+	unsigned long long total = 0;
+	for (const chess_move &m : moves) {
+		move_undo undo = chessboard.make_move(m);
+		unsigned long long nodes = perft(chessboard, opposite_colour(team_colour), depth - 1);
+		chessboard.unmake_move(undo);
+		std::cout << move_text(m) << ": " << nodes << std::endl;
+		total += nodes;
+	}
+	std::cout << "\nMoves: " << moves.size() << "\nNodes: " << total << std::endl;
+	return total;
+}
+
+// [3]  Function to check that the move generator and board::valid_board_move agree on every node down to a depth. Every start and end square pair is
+//      tried with valid_board_move and a move is legal if it is valid and leaves the king out of check, the same test game_player::attempt_move uses.
+//      The board's Zobrist key is also compared with the key worked out from scratch, which catches any move that updates the key wrongly
+
+unsigned long long validate(board &chessboard, colour team_colour, int depth, unsigned long long &mismatches)
+{
+	move_list moves;
+	chessboard.generate_legal_moves(team_colour, moves);
+
+	if (chessboard.hash_key() != position_key(chessboard.get_position(), chessboard.team_to_move(), chessboard.castling(), chessboard.en_passant())) {
+		if (mismatches++ < 10) std::cout << "Zobrist key mismatch" << chessboard << std::endl;
+	}
+	char fen[max_fen_length];
+	chessboard.to_fen(fen);
+	board read_back;
+	if (read_back.from_fen(fen) == false || read_back.hash_key() != chessboard.hash_key() || read_back.halfmoves() != chessboard.halfmoves()
+		|| read_back.move_number() != chessboard.move_number()) {
+		if (mismatches++ < 10) std::cout << "FEN doesn't read back the same: " << fen << chessboard << std::endl;
+	}
+
+	if (chessboard.has_legal_move(team_colour) != (moves.size() > 0)) {
+		if (mismatches++ < 10) std::cout << "has_legal_move says " << (moves.size() > 0 ? "no" : "yes") << " but there are " << moves.size() << " moves" << chessboard << std::endl;
+	}
+
+	bool generated[64][64] = {};
+	for (const chess_move &m : moves) generated[m.from][m.to] = true;
+	for (int from = 0; from < 64; from++) {
+		square start_square = chessboard.access_board_square(index_row(from), index_column(from));
+		for (int to = 0; to < 64; to++) {
+			bool legal = false;
+			if (chessboard.valid_board_move(team_colour, start_square, chessboard.access_board_square(index_row(to), index_column(to))) == true) {
+				move_undo undo = chessboard.make_move(chess_move(from, to));
+				legal = chessboard.is_king_in_check(chessboard.find_king_square(team_colour), team_colour) == false;
+				chessboard.unmake_move(undo);
+			}
+			if (legal != generated[from][to]) {
+				if (mismatches++ < 10) {
+					std::cout << "Mismatch on " << move_text(chess_move(from, to)) << ": valid_board_move says " << (legal ? "legal" : "illegal")
+						<< ", generate_legal_moves says " << (generated[from][to] ? "legal" : "illegal") << chessboard << std::endl;
+				}
+			}
+		}
+	}
+
+	if (depth <= 1) return 1;
+	unsigned long long nodes = 1;
+	for (const chess_move &m : moves) {
+		move_undo undo = chessboard.make_move(m);
+		nodes += validate(chessboard, opposite_colour(team_colour), depth - 1, mismatches);
+		chessboard.unmake_move(undo);
+	}
+	return nodes;
+}
+
+// [4]  Function to run every position of the reference suite to each of its known depths, returns false if any count is wrong
+
+bool run_suite()
+{
+	bool all_passed = true;
+	unsigned long long total_nodes = 0; double total_seconds = 0;
+	for (const perft_test &test : reference_suite) {
+		std::cout << test.name << std::endl;
+		board chessboard;
+		if (chessboard.from_fen(test.fen) == false) { std::cout << "  can't read " << test.fen << std::endl; all_passed = false; continue; }
+		for (int depth = 1; depth <= 8 && test.expected[depth - 1] != 0; depth++) {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			unsigned long long nodes = perft(chessboard, chessboard.team_to_move(), depth);
+			double seconds = seconds_since(start);
+			total_nodes += nodes; total_seconds += seconds;
+
+			bool passed = nodes == test.expected[depth - 1];
+			all_passed = all_passed && passed;
+			std::cout << "  depth " << depth << std::setw(14) << nodes << "  " << (passed ? "ok    " : "FAILED") << "  ";
+			if (passed == false) std::cout << "(expected " << test.expected[depth - 1] << ")  ";
+			print_speed(nodes, seconds);
+		}
+	}
+	std::cout << "\nTotal " << total_nodes << " nodes   ";
+	print_speed(total_nodes, total_seconds);
+	std::cout << (all_passed ? "All counts match" : "SOME COUNTS ARE WRONG") << std::endl;
+	return all_passed;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2) return run_suite() ? 0 : 1;
+
+	std::string mode = argv[1];
+	board chessboard;
+	if (mode == "validate") {
+		int depth = argc > 2 ? std::atoi(argv[2]) : 3;
+		if (argc > 3 && chessboard.from_fen(argv[3]) == false) { std::cerr << "Can't read the FEN" << std::endl; return 1; }
+		unsigned long long mismatches = 0;
+		unsigned long long nodes = validate(chessboard, chessboard.team_to_move(), depth, mismatches);
+		std::cout << "Validated " << nodes << " positions, " << mismatches << " mismatches" << std::endl;
+		return mismatches == 0 ? 0 : 1;
+	}
+
+	int depth = std::atoi(argv[1]);
+	if (mode == "fen") {
+		if (argc < 3 || chessboard.from_fen(argv[2]) == false) { std::cerr << "Can't read the FEN" << std::endl; return 1; }
+		depth = argc > 3 ? std::atoi(argv[3]) : 1;
+	}
+	if (depth < 1) { std::cerr << "Usage: perft [depth | fen \"<FEN>\" depth | validate depth]" << std::endl; return 1; }
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	unsigned long long nodes = divide(chessboard, chessboard.team_to_move(), depth);
+	std::cout << "Time: ";
+	print_speed(nodes, seconds_since(start));
+	return 0;
+}
@@ -0,0 +1,384 @@
+// pgn.cpp implements the functions defined in the pgn.h header file
+
+#include "pgn.h"
+#include "mapped_file.h"
+#include "piece_attacks.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace {
+	const std::size_t chunk_size = 1 << 20;		// The archive is shared out between the workers a megabyte at a time
+
+	bool is_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+	// Function to find the piece type of a SAN piece letter, returns false for a letter which isn't a piece
+	bool san_piece(char letter, piece_index &type)
+	{
+		switch (letter) {
+		case 'N':	type = knight_index; return true;
+		case 'B':	type = bishop_index; return true;
+		case 'R':	type = rook_index; return true;
+		case 'Q':	type = queen_index; return true;
+		case 'K':	type = king_index; return true;
+		default:	return false;
+		}
+	}
+
+	// Function to find the start squares of the pieces of a type which could move to a square, before checking that the move is legal. The sliding and
+	// stepping pieces are found by looking outwards from the destination (a knight on "to" attacks exactly the squares a knight could come from), pawns
+	// come from the square behind the destination (or two behind from the starting row) or take diagonally
+	bitboard candidate_squares(const board &chessboard, colour team_colour, piece_index type, int to, bool capture)
+	{
+		const position &p = chessboard.get_position();
+		bitboard own = p.piece_sets[team_colour][type];
+		if (type != pawn_index) return piece_attacks(team_colour, type, to, p.occupancy()) & own;
+
+		if (capture == true) { //a pawn takes diagonally forward onto an enemy piece (or the square an enemy pawn has just passed over, en passant), so it
+			                   //comes from a square the enemy pawns would attack
+			bool en_passant = chessboard.en_passant() != no_en_passant && to == square_index(team_colour == white ? 2 : 5, chessboard.en_passant());
+			if ((p.team_occupancy[opposite_colour(team_colour)] & square_bit(to)) == 0 && en_passant == false) return 0;
+			return pawn_attacks(opposite_colour(team_colour), to) & own;
+		}
+		if (p.is_occupied(to) == true) return 0;
+		int backward = team_colour == white ? 8 : -8; //white pawns move towards row 0, so they come from the row below
+		int one_back = to + backward;
+		if (one_back < 0 || one_back > 63) return 0;
+		if (own & square_bit(one_back)) return square_bit(one_back);
+		int double_row = team_colour == white ? 4 : 3; //rank 4 for white and rank 5 for black
+		if (index_row(to) == double_row && p.is_occupied(one_back) == false) return own & square_bit(one_back + backward);
+		return 0;
+	}
+
+	// Function to read the outcome of a result token, returns false if the token isn't a result
+	bool result_token(std::string_view token, game_outcome &outcome)
+	{
+		if (token == "1-0") outcome = outcome_white_wins;
+		else if (token == "0-1") outcome = outcome_black_wins;
+		else if (token == "1/2-1/2") outcome = outcome_draw;
+		else if (token == "*") outcome = outcome_unknown;
+		else return false;
+		return true;
+	}
+
+	// Function to find the value between the quotes of a tag line such as [FEN "..."]
+	std::string_view tag_value(std::string_view tag)
+	{
+		std::size_t open_quote = tag.find('"');
+		if (open_quote == std::string_view::npos) return std::string_view();
+		std::size_t close_quote = tag.find('"', open_quote + 1);
+		if (close_quote == std::string_view::npos) return std::string_view();
+		return tag.substr(open_quote + 1, close_quote - open_quote - 1);
+	}
+}
+
+// [1]  Function to find the legal move a SAN move describes, returns false if there isn't exactly one. The check and mate marks and annotations (+ # ! ?) at
+//      the end are ignored, the promotion piece (=Q) is read (a pawn reaching the last row without one becomes a queen) and the destination square is the
+//      last two characters left. Anything between the piece letter and the destination is a file or rank telling two pieces apart, or the "x" of a capture
+
+bool resolve_san(std::string_view san, const board &chessboard, chess_move &m)
+{
+	colour team_colour = chessboard.team_to_move();
+	while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?')) san.remove_suffix(1);
+
+	//CASTLING is written as the king's move
+	if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+		int king_square = team_colour == white ? 60 : 4;
+		chess_move castle(king_square, san.size() == 3 ? king_square + 2 : king_square - 2);
+		move_list moves;
+		chessboard.generate_legal_moves(team_colour, moves);
+		if (std::find(moves.begin(), moves.end(), castle) == moves.end()) return false;
+		m = castle;
+		return true;
+	}
+
+	//PROMOTION
+	piece_index promotion = queen_index;
+	if (san.size() >= 2 && san[san.size() - 2] == '=') { if (san_piece(san.back(), promotion) == false || promotion == king_index) return false; san.remove_suffix(2); }
+	else if (san.size() >= 3 && san[0] >= 'a' && san[0] <= 'h' && (san.back() == 'Q' || san.back() == 'R' || san.back() == 'B' || san.back() == 'N')) {
+		san_piece(san.back(), promotion); san.remove_suffix(1);
+	}
+
+	//DESTINATION
+	if (san.size() < 2) return false;
+	char to_file = san[san.size() - 2], to_rank = san[san.size() - 1];
+	if (to_file < 'a' || to_file > 'h' || to_rank < '1' || to_rank > '8') return false;
+	int to = square_index('8' - to_rank, to_file - 'a');
+	san.remove_suffix(2);
+
+	//PIECE, DISAMBIGUATION AND CAPTURE
+	piece_index type = pawn_index;
+	if (!san.empty() && san_piece(san[0], type) == true) san.remove_prefix(1);
+	bool capture = false;
+	bitboard from_mask = ~bitboard(0);
+	for (char c : san) {
+		if (c == 'x' || c == ':') capture = true;
+		else if (c >= 'a' && c <= 'h') from_mask &= 0x0101010101010101ULL << (c - 'a');
+		else if (c >= '1' && c <= '8') from_mask &= 0xffULL << (8 * ('8' - c));
+		else return false;
+	}
+	if (chessboard.get_position().team_occupancy[team_colour] & square_bit(to)) return false; //a piece can't move onto its own team
+
+	bitboard candidates = candidate_squares(chessboard, team_colour, type, to, capture || (type == pawn_index && from_mask != ~bitboard(0))) & from_mask;
+	int found = 0;
+	bool promoting = type == pawn_index && (to < 8 || to >= 56);
+	while (candidates) {
+		chess_move candidate(pop_lowest_square(candidates), to, promoting ? std::uint8_t(promotion) : no_promotion);
+		if (chessboard.leaves_king_safe(team_colour, candidate) == true) { m = candidate; found++; }
+	}
+	return found == 1;
+}
+
+// [2]  Function to write a legal move in SAN into a buffer of at least 8 characters, returns its length. The start file or rank is only written if
+//      another piece of the same type could also legally move to the same square, and the move is made on a copy of the board to see if it gives check or mate
+
+int write_san(const board &chessboard, const chess_move &m, char *buffer)
+{
+	static const char piece_letters[number_of_piece_types] = { 'P', 'N', 'B', 'R', 'Q', 'K' };
+	const position &p = chessboard.get_position();
+	colour team_colour; piece_index type;
+	char *out = buffer;
+	if (p.find_piece(m.from, team_colour, type) == false) { *out = '\0'; return 0; }
+	bool capture = p.is_occupied(m.to);
+
+	if (type == king_index && (m.to - m.from == 2 || m.from - m.to == 2)) { //castling
+		const char *castle = m.to > m.from ? "O-O" : "O-O-O";
+		while (*castle) *out++ = *castle++;
+	}
+	else if (type == pawn_index) {
+		if (index_column(m.from) != index_column(m.to)) { *out++ = char('a' + index_column(m.from)); *out++ = 'x'; capture = true; }
+		*out++ = char('a' + index_column(m.to)); *out++ = char('8' - index_row(m.to));
+		if (m.to < 8 || m.to >= 56) { *out++ = '='; *out++ = piece_letters[m.promotion != no_promotion ? m.promotion : std::uint8_t(queen_index)]; }
+	}
+	else {
+		*out++ = piece_letters[type];
+		bitboard others = candidate_squares(chessboard, team_colour, type, m.to, capture) & ~square_bit(m.from);
+		bool same_column = false, same_row = false, ambiguous = false;
+		while (others) {
+			int other = pop_lowest_square(others);
+			if (chessboard.leaves_king_safe(team_colour, chess_move(other, m.to)) == false) continue;
+			ambiguous = true;
+			if (index_column(other) == index_column(m.from)) same_column = true;
+			if (index_row(other) == index_row(m.from)) same_row = true;
+		}
+		if (ambiguous == true) { //the file is enough unless another piece is on the same file, then the rank, and both if both are shared
+			if (same_column == false) *out++ = char('a' + index_column(m.from));
+			else if (same_row == false) *out++ = char('8' - index_row(m.from));
+			else { *out++ = char('a' + index_column(m.from)); *out++ = char('8' - index_row(m.from)); }
+		}
+		if (capture == true) *out++ = 'x';
+		*out++ = char('a' + index_column(m.to)); *out++ = char('8' - index_row(m.to));
+	}
+
+	board after = chessboard;
+	after.make_move(m);
+	colour opponent = opposite_colour(team_colour);
+	if (after.checking_pieces(opponent) != 0) *out++ = after.has_legal_move(opponent) ? '+' : '#';
+	*out = '\0';
+	return int(out - buffer);
+}
+
+// [3]  Function to find the start of the first game at or after a position in the archive. A game starts with a line beginning "[" (its first tag) that
+//      follows a line of moves or the start of the archive, so the other tag lines of the same game are skipped over. Returns the length of the text if
+//      there are no more games
+
+std::size_t next_game_start(std::string_view text, std::size_t from)
+{
+	if (from == 0) return 0;
+	std::size_t line_start = text.find('\n', from - 1);
+	while (line_start != std::string_view::npos && ++line_start < text.size()) {
+		if (text[line_start] == '[') {
+			//look back past blank lines to the previous line, the game starts here if that line isn't a tag
+			std::size_t back = line_start;
+			while (back > 0 && is_space(text[back - 1])) back--;
+			std::size_t previous_line = text.rfind('\n', back == 0 ? 0 : back - 1);
+			previous_line = previous_line == std::string_view::npos ? 0 : previous_line + 1;
+			if (back == 0 || text[previous_line] != '[') return line_start;
+		}
+		line_start = text.find('\n', line_start);
+	}
+	return text.size();
+}
+
+// [4]  Function to replay one game from its tags and moves. The game starts from the start position unless a FEN tag gives another one, then each SAN
+//      move is found among the legal moves and made on the board. Move numbers, comments ({...} or ; to the end of the line), variations in brackets and
+//      numeric annotations ($1) are skipped, and the result token ends the game. A record is only complete if the game is valid and has no more than
+//      max_stored_plies moves
+
+pgn_game replay_game(std::string_view game_text, board &chessboard, const move_visitor &visit, int thread_number, stored_game *record)
+{
+	pgn_game game{ 0, 0, nullptr, std::string_view(), outcome_unknown };
+	std::size_t i = 0;
+	bool board_set_up = false;
+
+	//TAGS
+	for (;;) {
+		while (i < game_text.size() && is_space(game_text[i])) i++;
+		if (i >= game_text.size() || game_text[i] != '[') break;
+		std::size_t line_end = game_text.find('\n', i);
+		if (line_end == std::string_view::npos) line_end = game_text.size();
+		std::string_view tag = game_text.substr(i, line_end - i);
+		if (tag.compare(0, 5, "[FEN ") == 0) {
+			if (chessboard.from_fen(tag_value(tag)) == false) { game.error = "the FEN tag can't be read"; game.token = tag; return game; }
+			board_set_up = true;
+		}
+		i = line_end;
+	}
+	if (board_set_up == false) chessboard.from_fen(start_fen);
+	if (record != nullptr) {
+		record->has_start_position = board_set_up;
+		if (board_set_up) record->start_position = pack_position(chessboard);
+		record->number_of_moves = 0;
+	}
+
+	//MOVES
+	while (i < game_text.size()) {
+		char c = game_text[i];
+		if (is_space(c)) { i++; continue; }
+		if (c == '{') { i = game_text.find('}', i); i = i == std::string_view::npos ? game_text.size() : i + 1; continue; }
+		if (c == ';' || c == '%') { i = game_text.find('\n', i); if (i == std::string_view::npos) i = game_text.size(); continue; }
+		if (c == '(') { //variations can contain variations and comments
+			int depth = 0;
+			for (; i < game_text.size(); i++) {
+				if (game_text[i] == '{') { i = game_text.find('}', i); if (i == std::string_view::npos) i = game_text.size() - 1; }
+				else if (game_text[i] == '(') depth++;
+				else if (game_text[i] == ')' && --depth == 0) { i++; break; }
+			}
+			continue;
+		}
+		if (c == '[') break; //the tags of the next game, which has no result token before it
+
+		std::size_t end = i;
+		while (end < game_text.size() && !is_space(game_text[end]) && game_text[end] != '{' && game_text[end] != '(' && game_text[end] != ';') end++;
+		std::string_view token = game_text.substr(i, end - i);
+		i = end;
+		if (token[0] == '$' || token[0] == ')') continue;
+		if (result_token(token, game.outcome) == true) break;
+
+		//a move number ("12." or "12...") may be written against the move that follows it
+		std::size_t number_end = 0;
+		while (number_end < token.size() && token[number_end] >= '0' && token[number_end] <= '9') number_end++;
+		if (number_end > 0 && number_end < token.size() && token[number_end] == '.') {
+			while (number_end < token.size() && token[number_end] == '.') number_end++;
+			token.remove_prefix(number_end);
+			if (token.empty()) continue;
+		}
+
+		chess_move m(0, 0);
+		if (resolve_san(token, chessboard, m) == false) { game.error = "not a legal move"; game.token = token; return game; }
+		if (visit) visit(thread_number, chessboard, m);
+		if (record != nullptr && game.plies < max_stored_plies) record->moves[game.plies] = pack_move(m);
+		chessboard.make_move(m);
+		game.plies++;
+	}
+	if (record != nullptr) { record->number_of_moves = game.plies; record->outcome = std::uint8_t(game.outcome); }
+	return game;
+}
+
+// [5]  Function to replay every game of an archive with worker threads, keeping the first max_errors invalid games (in the order of the archive). Each
+//      worker takes the next chunk of the archive and replays the games that start in it (the last one may run on into the next chunk), so the workers
+//      never need to agree on where the games are and no game is read twice. A worker storing games keeps the valid games of its chunk until the chunk is
+//      finished, and the chunks are written in order as soon as every chunk before them has been, so the file holds the games in the order of the archive
+//      and only the chunks finished out of turn wait in memory
+
+pgn_statistics replay_archive(std::string_view text, int number_of_threads, std::vector<pgn_game> &errors, std::size_t max_errors, const move_visitor &visit,
+	record_writer *store)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (number_of_threads < 1) number_of_threads = 1;
+	std::atomic<std::size_t> next_chunk{ 0 };
+	std::size_t number_of_chunks = (text.size() + chunk_size - 1) / chunk_size;
+	std::vector<pgn_statistics> thread_statistics(number_of_threads);
+	std::vector<std::vector<pgn_game>> thread_errors(number_of_threads);
+	std::mutex store_lock;
+	std::map<std::size_t, std::vector<stored_game>> finished_chunks; //the stored games of chunks finished before an earlier chunk, by chunk number
+	std::size_t next_chunk_to_store = 0;
+
+	auto worker = [&](int thread_number) {
+		board chessboard;
+		pgn_statistics &statistics = thread_statistics[thread_number];
+		std::unique_ptr<stored_game> record(store != nullptr ? new stored_game() : nullptr);
+		for (std::size_t chunk = next_chunk++; chunk < number_of_chunks; chunk = next_chunk++) {
+			std::size_t chunk_end = std::min((chunk + 1) * chunk_size, text.size());
+			std::vector<stored_game> chunk_games;
+			for (std::size_t game_start = next_game_start(text, chunk * chunk_size); game_start < chunk_end;) {
+				std::size_t game_end = next_game_start(text, game_start + 1);
+				pgn_game game = replay_game(text.substr(game_start, game_end - game_start), chessboard, visit, thread_number, record.get());
+				game.offset = game_start;
+				statistics.games++; statistics.plies += game.plies;
+				if (game.error == nullptr) statistics.valid_games++;
+				else if (thread_errors[thread_number].size() < max_errors) thread_errors[thread_number].push_back(game);
+				if (record != nullptr && game.error == nullptr && game.plies <= max_stored_plies) chunk_games.push_back(*record);
+				game_start = game_end;
+			}
+			if (store != nullptr) {
+				std::lock_guard<std::mutex> lock(store_lock);
+				finished_chunks[chunk] = std::move(chunk_games);
+				for (auto next = finished_chunks.begin(); next != finished_chunks.end() && next->first == next_chunk_to_store; next = finished_chunks.erase(next)) {
+					for (const stored_game &stored : next->second) store->write_game(stored);
+					statistics.stored_games += next->second.size();
+					next_chunk_to_store++;
+				}
+			}
+		}
+	};
+	std::vector<std::thread> workers;
+	for (int number = 1; number < number_of_threads; number++) workers.emplace_back(worker, number);
+	worker(0);
+	for (std::thread &t : workers) t.join();
+
+	pgn_statistics total;
+	errors.clear();
+	for (int number = 0; number < number_of_threads; number++) {
+		total.games += thread_statistics[number].games; total.valid_games += thread_statistics[number].valid_games; total.plies += thread_statistics[number].plies;
+		total.stored_games += thread_statistics[number].stored_games;
+		errors.insert(errors.end(), thread_errors[number].begin(), thread_errors[number].end());
+	}
+	std::sort(errors.begin(), errors.end(), [](const pgn_game &a, const pgn_game &b) { return a.offset < b.offset; });
+	if (errors.size() > max_errors) errors.resize(max_errors);
+	total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return total;
+}
+
+// [6]  Function to run the PGN mode from the command line arguments that follow "--pgn": the archive to read, an optional "--threads N" (every core by
+//      default) and an optional "--store FILE" to write the valid games to. The invalid games are listed by their byte offset in the archive, followed by a
+//      summary with the speed
+
+int pgn_main(int argc, char *argv[])
+{
+	const char *file_name = nullptr;
+	const char *store_name = nullptr;
+	int number_of_threads = int(std::thread::hardware_concurrency());
+	for (int i = 0; i < argc; i++) {
+		std::string argument = argv[i];
+		if (argument == "--threads" && i + 1 < argc) number_of_threads = std::atoi(argv[++i]);
+		else if (argument == "--store" && i + 1 < argc) store_name = argv[++i];
+		else file_name = argv[i];
+	}
+	if (file_name == nullptr) { std::cerr << "Usage: chess --pgn <file> [--threads N] [--store FILE]" << std::endl; return 1; }
+	mapped_file archive;
+	if (archive.open(file_name) == false) { std::cerr << "Can't open " << file_name << std::endl; return 1; }
+	record_writer store;
+	if (store_name != nullptr && store.open(store_name, game_records) == false) { std::cerr << "Can't create " << store_name << std::endl; return 1; }
+
+	std::vector<pgn_game> errors;
+	pgn_statistics statistics = replay_archive(archive.text(), number_of_threads, errors, 100, nullptr, store_name != nullptr ? &store : nullptr);
+	for (const pgn_game &game : errors) {
+		std::cout << "Game at byte " << game.offset << ", move " << game.plies / 2 + 1 << (game.plies % 2 ? "..." : ". ") << game.token << ": " << game.error << "\n";
+	}
+	std::cout << statistics.games << " games, " << statistics.valid_games << " valid, " << statistics.plies << " moves in " << statistics.seconds << " s ("
+		<< (statistics.seconds > 0 ? statistics.games / statistics.seconds : 0) << " games/s, " << (statistics.seconds > 0 ? statistics.plies / statistics.seconds : 0)
+		<< " moves/s)" << std::endl;
+	if (store_name != nullptr) {
+		if (store.close() == false) { std::cerr << "Can't write " << store_name << std::endl; return 1; }
+		std::cout << statistics.stored_games << " games stored in " << store_name << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,50 @@
+// pgn.h declares the reader for games in Portable Game Notation (PGN). A PGN archive is read by memory mapping it, so the archive is never copied into
+// memory and the memory used doesn't grow with its size. The archive is split into chunks of about a megabyte and worker threads take chunks in turn,
+// each replaying the games that start in its chunk on its own board. The moves of a game are written in Standard Algebraic Notation (SAN, e.g. "Nf3",
+// "exd5", "O-O") and each one is read in place in the mapped text: the piece type, destination square and any file or rank given to tell two pieces
+// apart are used to find the start square among the pieces that attack the destination, and the move is only accepted if it is legal. A game is valid if
+// every move in it is legal. The valid games can be stored in a file of game records (see storage.h) in the order of the archive
+
+#ifndef PGN_H
+#define PGN_H
+
+#include "board_and_players.h"
+#include "storage.h"
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+enum game_outcome { outcome_unknown, outcome_white_wins, outcome_black_wins, outcome_draw };
+
+																																// PGN_GAME STRUCT
+struct pgn_game {																												//--------------------------------------------------------------------------------------------------------
+	std::size_t offset;			// Where the game starts in the archive, in bytes
+	int plies;					// The number of moves (of either team) that were played
+	const char *error;			// Why the game isn't valid, or nullptr if it is
+	std::string_view token;		// The move or tag the error was found at
+	game_outcome outcome;		// The result given by the game
+};
+
+																																// PGN_STATISTICS STRUCT
+struct pgn_statistics {																											//--------------------------------------------------------------------------------------------------------
+	unsigned long long games = 0;			// The number of games read
+	unsigned long long valid_games = 0;		// The number of games whose every move was legal
+	unsigned long long plies = 0;			// The number of moves played in all of the games
+	unsigned long long stored_games = 0;	// The number of valid games written to the store (a game longer than max_stored_plies isn't)
+	double seconds = 0;						// The time taken
+};
+
+typedef std::function<void(int thread_number, const board &before, const chess_move &m)> move_visitor;	// Called for each move replayed, with the board before the move
+
+bool resolve_san(std::string_view san, const board &chessboard, chess_move &m);													// [1]  Function to find the legal move a SAN move describes, returns false if there isn't exactly one
+int write_san(const board &chessboard, const chess_move &m, char *buffer);														// [2]  Function to write a legal move in SAN into a buffer of at least 8 characters, returns its length
+std::size_t next_game_start(std::string_view text, std::size_t from);															// [3]  Function to find the start of the first game at or after a position in the archive
+pgn_game replay_game(std::string_view game_text, board &chessboard, const move_visitor &visit = nullptr, int thread_number = 0,	// [4]  Function to replay one game from its tags and moves, filling in
+	stored_game *record = nullptr);																								//      record with its start position, moves and result if it isn't nullptr
+pgn_statistics replay_archive(std::string_view text, int number_of_threads, std::vector<pgn_game> &errors, std::size_t max_errors,	// [5]  Function to replay every game of an archive with worker threads,
+	const move_visitor &visit = nullptr, record_writer *store = nullptr);														//      keeping the first max_errors invalid games and storing the valid
+																																//      games if store isn't nullptr
+int pgn_main(int argc, char *argv[]);																							// [6]  Function to run the PGN mode from the command line arguments that follow "--pgn"
+
+#endif
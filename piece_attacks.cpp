@@ -0,0 +1,198 @@
+// piece_attacks.cpp implements the functions defined in the piece_attacks.h header file
+
+#include "piece_attacks.h"
+
+magic_entry bishop_magics[64];
+magic_entry rook_magics[64];
+bitboard between_table[64][64];
+bitboard line_table[64][64];
+
+namespace {
+	// The attack sets of every sliding piece on every square for every occupancy of its mask, 102400 rook entries then 5248 bishop entries
+	bitboard sliding_table[102400 + 5248];
+
+	// Function to trace a ray from a square in one direction, adding each square until the edge of the board or the first occupied square (which is included)
+	bitboard ray_attacks(int index, bitboard occupied, int row_step, int column_step)
+	{
+		bitboard attacks = 0;
+		int row = index_row(index) + row_step; int column = index_column(index) + column_step;
+		while (row >= 0 && row < 8 && column >= 0 && column < 8) {
+			bitboard bit = square_bit(square_index(row, column));
+			attacks |= bit;
+			if (occupied & bit) break; //the ray is blocked by this piece
+			row += row_step; column += column_step;
+		}
+		return attacks;
+	}
+
+	// Function to trace all four rays of a bishop or rook (given by their row and column steps), used to fill in the magic tables
+	bitboard traced_attacks(int index, bitboard occupied, const int steps[4][2])
+	{
+		bitboard attacks = 0;
+		for (int i = 0; i < 4; i++) attacks |= ray_attacks(index, occupied, steps[i][0], steps[i][1]);
+		return attacks;
+	}
+
+	// Magic numbers for each square, found once by trying random numbers with few set bits until one gave every occupancy of the square's mask its own
+	// table index (or shared an index only between occupancies with the same attacks)
+	const bitboard rook_magic_numbers[64] = {
+		0x0480046281400010ULL, 0x80c0200010004000ULL, 0x8780200008300180ULL, 0x8880060800100080ULL,
+		0x2100030010080084ULL, 0x0100040001000802ULL, 0x0200040800810200ULL, 0x0580008002407100ULL,
+		0x1000800080400020ULL, 0x0080401000402001ULL, 0x800c802002100880ULL, 0x800a002200884010ULL,
+		0x2046002008108600ULL, 0x0222009002000804ULL, 0x100b000421001200ULL, 0x0240800100004080ULL,
+		0x4540008020408006ULL, 0x8010054020084002ULL, 0x7d10010100200040ULL, 0x1408008010000882ULL,
+		0x4408010005000810ULL, 0x001e008004000280ULL, 0x0230040001080210ULL, 0x0000020004004081ULL,
+		0x0100400080208001ULL, 0x1000842300400100ULL, 0x1060100080200082ULL, 0x3219004b00100020ULL,
+		0x9010080080800400ULL, 0x8440020080800400ULL, 0x6008010080800200ULL, 0x4123008200010044ULL,
+		0x0280002001400240ULL, 0x0220100040400020ULL, 0x0060801003802008ULL, 0x0008100080800800ULL,
+		0x0105000801001004ULL, 0x100b000803000400ULL, 0x0000024814001021ULL, 0x00408000c2802100ULL,
+		0x4c40004020808002ULL, 0x4410500420024000ULL, 0x00c0100020008080ULL, 0x0000100008008080ULL,
+		0x8002000804220011ULL, 0x0802000804010100ULL, 0x0243100201040008ULL, 0x0000009100420014ULL,
+		0x1000400280022480ULL, 0x0020200040100040ULL, 0x00a000100800c140ULL, 0x0410001408008080ULL,
+		0x0000080004008080ULL, 0x0100020004008080ULL, 0x0303000200040300ULL, 0x1480006104008200ULL,
+		0x00008002204a1101ULL, 0x1040090010224081ULL, 0x4300c0200011000dULL, 0x8002041001002009ULL,
+		0x2005000800020411ULL, 0x110a008408100102ULL, 0x0006000108008402ULL, 0x0200002900884402ULL
+	};
+	const bitboard bishop_magic_numbers[64] = {
+		0x10300c10a4084200ULL, 0x000948110c0b2081ULL, 0x0944140400500000ULL, 0x4984104a00000101ULL,
+		0x4004030818283008ULL, 0x0206012462000121ULL, 0x1a02013008040001ULL, 0x0001008044200440ULL,
+		0x0000312208080880ULL, 0x0220021002009900ULL, 0x8080880801082000ULL, 0x000c11040080102aULL,
+		0x1402440421000210ULL, 0x0010120802080a81ULL, 0x0080084202104028ULL, 0x1100002082082082ULL,
+		0x0008403429080820ULL, 0x8104868204040412ULL, 0x6424084043060030ULL, 0x1108000420401000ULL,
+		0x9004101202020240ULL, 0x0032400608200412ULL, 0x0001009610822080ULL, 0x0008403429080820ULL,
+		0x0008068340104200ULL, 0x0010102858090121ULL, 0x81004c0018080313ULL, 0x4048080004820002ULL,
+		0x000900401c004049ULL, 0x0009420121c1101cULL, 0x4828504005040211ULL, 0x4828504005040211ULL,
+		0x0041041381202000ULL, 0x01008c1005601680ULL, 0x01d010900002040aULL, 0x4040020080080080ULL,
+		0x4801080200802200ULL, 0x4801080200802200ULL, 0x0010046108108080ULL, 0x90409090810a0220ULL,
+		0x8004020242201020ULL, 0x8004020242201020ULL, 0x0202010028020480ULL, 0x0000041144000801ULL,
+		0x00002000a4021080ULL, 0x0504090045040200ULL, 0x8182041102094400ULL, 0x0550008100480101ULL,
+		0xc002080404040400ULL, 0x0382004108292000ULL, 0x12000100a8040020ULL, 0xa005020442088020ULL,
+		0x2000001102020300ULL, 0x000021e0420c8808ULL, 0x3060200484888400ULL, 0x01280101021a0802ULL,
+		0x1030820110010500ULL, 0x0080012608025800ULL, 0x0002810084008800ULL, 0x800080000c208800ULL,
+		0xa408002140028204ULL, 0x0010006020322084ULL, 0x0210401044110050ULL, 0x40106000a1160020ULL
+	};
+
+	// Function to fill in the magic entries and attack table of one sliding piece type, starting at "table" and returning the end of the entries used.
+	// For each square every occupancy of the mask is listed (the Carry-Rippler trick) and its attack set is traced and stored at its table index
+	bitboard *fill_magic_table(magic_entry magics[64], const bitboard magic_numbers[64], const int steps[4][2], bitboard *table)
+	{
+		for (int index = 0; index < 64; index++) {
+			int row = index_row(index); int column = index_column(index);
+			bitboard row_edges = (0x00000000000000ffULL | 0xff00000000000000ULL) & ~(0x00000000000000ffULL << (8 * row));
+			bitboard column_edges = (0x0101010101010101ULL | 0x8080808080808080ULL) & ~(0x0101010101010101ULL << column);
+			magic_entry &entry = magics[index];
+			entry.mask = traced_attacks(index, 0, steps) & ~(row_edges | column_edges);
+			entry.magic = magic_numbers[index];
+			entry.shift = unsigned(64 - count_squares(entry.mask));
+			entry.attacks = table;
+
+			bitboard subset = 0;
+			do {
+				table[entry.index(subset)] = traced_attacks(index, subset, steps);
+				subset = (subset - entry.mask) & entry.mask;
+			} while (subset);
+			table += bitboard(1) << count_squares(entry.mask);
+		}
+		return table;
+	}
+
+	// Fill in the magic, between and line tables once when the program starts
+	struct attack_table_setup {
+		attack_table_setup()
+		{
+			const int straight_steps[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+			const int diagonal_steps[4][2] = { { -1, -1 }, { -1, 1 }, { 1, -1 }, { 1, 1 } };
+			fill_magic_table(bishop_magics, bishop_magic_numbers, diagonal_steps, fill_magic_table(rook_magics, rook_magic_numbers, straight_steps, sliding_table));
+
+			// Two squares share a line if a rook or bishop on an empty board attacks one from the other, the squares between them are the ones both
+			// attack when each has the other square as its only blocker
+			for (int index_1 = 0; index_1 < 64; index_1++) {
+				for (int index_2 = 0; index_2 < 64; index_2++) {
+					between_table[index_1][index_2] = 0; line_table[index_1][index_2] = 0;
+					if (index_1 == index_2) continue;
+					bitboard ends = square_bit(index_1) | square_bit(index_2);
+					if (rook_attacks(index_1, 0) & square_bit(index_2)) {
+						line_table[index_1][index_2] = (rook_attacks(index_1, 0) & rook_attacks(index_2, 0)) | ends;
+						between_table[index_1][index_2] = rook_attacks(index_1, square_bit(index_2)) & rook_attacks(index_2, square_bit(index_1));
+					}
+					else if (bishop_attacks(index_1, 0) & square_bit(index_2)) {
+						line_table[index_1][index_2] = (bishop_attacks(index_1, 0) & bishop_attacks(index_2, 0)) | ends;
+						between_table[index_1][index_2] = bishop_attacks(index_1, square_bit(index_2)) & bishop_attacks(index_2, square_bit(index_1));
+					}
+				}
+			}
+		}
+	} attack_tables;
+}
+
+// [12] Function to check if any piece of a team attacks a square. Rather than looking at every enemy piece, look outwards from the square with each type of
+//      piece and see if it lands on an enemy piece of that type (a knight on the square attacks a knight exactly when that knight attacks the square)
+
+bool square_attacked(const position &p, int index, colour attacking_colour)
+{
+	const bitboard *enemy = p.piece_sets[attacking_colour];
+	if (pawn_attacks(opposite_colour(attacking_colour), index) & enemy[pawn_index]) return true;
+	if (knight_attacks(index) & enemy[knight_index]) return true;
+	if (king_attacks(index) & enemy[king_index]) return true;
+	bitboard occupied = p.occupancy();
+	if (bishop_attacks(index, occupied) & (enemy[bishop_index] | enemy[queen_index])) return true;
+	if (rook_attacks(index, occupied) & (enemy[rook_index] | enemy[queen_index])) return true;
+	return false;
+}
+
+// [13] Function to find every piece of a team that attacks a square, the same look outwards from the square as square_attacked but collecting the pieces
+//      found. The sliding pieces are traced through the "occupied" squares given, so a caller can take pieces off the board before looking
+
+bitboard attackers_to(const position &p, int index, colour attacking_colour, bitboard occupied)
+{
+	const bitboard *enemy = p.piece_sets[attacking_colour];
+	return (pawn_attacks(opposite_colour(attacking_colour), index) & enemy[pawn_index])
+		| (knight_attacks(index) & enemy[knight_index])
+		| (king_attacks(index) & enemy[king_index])
+		| (bishop_attacks(index, occupied) & (enemy[bishop_index] | enemy[queen_index]))
+		| (rook_attacks(index, occupied) & (enemy[rook_index] | enemy[queen_index]));
+}
+
+// [14] Function to find every square attacked by any piece of a team, the pawns are shifted forward diagonally as a whole set and every other piece adds
+//      its attacked squares one piece at a time
+
+bitboard team_attacks(const position &p, colour attacking_colour)
+{
+	const bitboard not_column_0 = 0xfefefefefefefefeULL; const bitboard not_column_7 = 0x7f7f7f7f7f7f7f7fULL;
+	const bitboard *team = p.piece_sets[attacking_colour];
+	bitboard occupied = p.occupancy();
+	bitboard attacks;
+	if (attacking_colour == white) attacks = ((team[pawn_index] & not_column_0) >> 9) | ((team[pawn_index] & not_column_7) >> 7);
+	else attacks = ((team[pawn_index] & not_column_0) << 7) | ((team[pawn_index] & not_column_7) << 9);
+
+	bitboard pieces = team[knight_index];
+	while (pieces) attacks |= knight_attacks(pop_lowest_square(pieces));
+	pieces = team[bishop_index] | team[queen_index];
+	while (pieces) attacks |= bishop_attacks(pop_lowest_square(pieces), occupied);
+	pieces = team[rook_index] | team[queen_index];
+	while (pieces) attacks |= rook_attacks(pop_lowest_square(pieces), occupied);
+	pieces = team[king_index];
+	while (pieces) attacks |= king_attacks(pop_lowest_square(pieces));
+	return attacks;
+}
+
+// [15] Function to find the pieces of a team that are pinned to their own king. A piece is pinned if it is the only piece between the king and an enemy
+//      bishop, rook or queen on the same line
+
+bitboard pinned_pieces(const position &p, colour king_colour)
+{
+	bitboard king_set = p.piece_sets[king_colour][king_index];
+	if (king_set == 0) return 0;
+	int king = lowest_square(king_set);
+	const bitboard *enemy = p.piece_sets[opposite_colour(king_colour)];
+	bitboard occupied = p.occupancy();
+
+	//the enemy sliding pieces that would attack the king if the board were empty are the only ones that can pin
+	bitboard snipers = (rook_attacks(king, 0) & (enemy[rook_index] | enemy[queen_index])) | (bishop_attacks(king, 0) & (enemy[bishop_index] | enemy[queen_index]));
+	bitboard pinned = 0;
+	while (snipers) {
+		bitboard blockers = between(king, pop_lowest_square(snipers)) & occupied;
+		if (blockers && (blockers & (blockers - 1)) == 0 && (blockers & p.team_occupancy[king_colour])) pinned |= blockers; //exactly one piece in the way and it is the king's own
+	}
+	return pinned;
+}
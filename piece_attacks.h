@@ -0,0 +1,97 @@
+// piece_attacks.h declares the functions which find the squares attacked by each type of piece as a bitboard. The king, knight and pawn attacks never depend on
+// the other pieces so they are looked up in constexpr tables the compiler builds from each piece's steps, there is nothing to fill in at run time. The bishop, rook and queen attacks depend on which squares along their
+// lines are occupied, so they use "magic bitboards": the occupied squares that matter to a piece on a square are multiplied by a magic number which packs them
+// into a small index into a table of every possible attack set, so a sliding attack is a multiply, a shift and one table lookup. When the compiler targets a
+// processor with BMI2 the PEXT instruction packs the squares directly instead of the multiply. The between and line tables give the squares between two
+// squares and the whole line through them. These are the building blocks of the move generator and of the attack maps, check and pin detection in the board class.
+// The attacks<piece_index> template gives the movement rule of each piece type, so code which knows the piece type when it is compiled calls straight into
+// the right table with no virtual function or switch in between
+
+#ifndef PIECE_ATTACKS_H
+#define PIECE_ATTACKS_H
+
+#include "bitboard.h"
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+																																// MAGIC_ENTRY STRUCT
+struct magic_entry {																											//--------------------------------------------------------------------------------------------------------
+	bitboard mask;				// The squares whose occupancy changes the attacks of a sliding piece on this square (its lines without the edge of the board)
+	bitboard magic;				// The magic number which maps every occupancy of the mask to a different table index
+	const bitboard *attacks;	// This square's part of the attack table
+	unsigned shift;				// 64 minus the number of squares in the mask
+
+	unsigned index(bitboard occupied) const {																					// [1]  Function to find the table index for the occupied squares of the board
+#if defined(__BMI2__)
+		return unsigned(_pext_u64(occupied, mask));
+#else
+		return unsigned(((occupied & mask) * magic) >> shift);
+#endif
+	}
+};
+
+																																// STEP TABLES
+struct step_table {																												//--------------------------------------------------------------------------------------------------------
+	bitboard squares[64];		// The squares a piece on each square attacks, indexed by the bit index of the piece's square
+};
+
+// Row and column steps of the pieces which move a fixed distance, a step which would leave the board is skipped
+constexpr int knight_steps[8][2] = { { -2, -1 }, { -2, 1 }, { -1, -2 }, { -1, 2 }, { 1, -2 }, { 1, 2 }, { 2, -1 }, { 2, 1 } };
+constexpr int king_steps[8][2] = { { -1, -1 }, { -1, 0 }, { -1, 1 }, { 0, -1 }, { 0, 1 }, { 1, -1 }, { 1, 0 }, { 1, 1 } };
+constexpr int pawn_steps[2][2][2] = { { { 1, -1 }, { 1, 1 } }, { { -1, -1 }, { -1, 1 } } };	// Indexed by [colour], white pawns attack up the board (towards row 0) and black pawns down it
+
+constexpr step_table make_step_table(const int (*steps)[2], int number_of_steps) {												// [2]  Function to build the attack table of a piece from its steps when the program is compiled
+	step_table table{};
+	for (int index = 0; index < 64; index++) {
+		for (int i = 0; i < number_of_steps; i++) {
+			int row = (index >> 3) + steps[i][0]; int column = (index & 7) + steps[i][1];
+			if (row >= 0 && row < 8 && column >= 0 && column < 8) table.squares[index] |= bitboard(1) << (row * 8 + column);
+		}
+	}
+	return table;
+}
+
+inline constexpr step_table knight_table = make_step_table(knight_steps, 8);
+inline constexpr step_table king_table = make_step_table(king_steps, 8);
+inline constexpr step_table pawn_table[2] = { make_step_table(pawn_steps[black], 2), make_step_table(pawn_steps[white], 2) };
+
+extern magic_entry bishop_magics[64];
+extern magic_entry rook_magics[64];
+extern bitboard between_table[64][64];
+extern bitboard line_table[64][64];
+
+inline colour opposite_colour(colour team_colour) { return team_colour == white ? black : white; }								// [3]  Function to find the colour of the opposing team
+
+inline bitboard pawn_attacks(colour pawn_colour, int index) { return pawn_table[pawn_colour].squares[index]; }					// [4]  Function to find the squares a pawn attacks diagonally forward
+inline bitboard knight_attacks(int index) { return knight_table.squares[index]; }												// [5]  Function to find the squares a knight attacks
+inline bitboard king_attacks(int index) { return king_table.squares[index]; }													// [6]  Function to find the squares a king attacks
+inline bitboard bishop_attacks(int index, bitboard occupied) { return bishop_magics[index].attacks[bishop_magics[index].index(occupied)]; }	// [7]  Function to find the squares a bishop attacks along its diagonals up to the first blocking piece
+inline bitboard rook_attacks(int index, bitboard occupied) { return rook_magics[index].attacks[rook_magics[index].index(occupied)]; }	// [8]  Function to find the squares a rook attacks along its row and column up to the first blocking piece
+inline bitboard queen_attacks(int index, bitboard occupied) { return bishop_attacks(index, occupied) | rook_attacks(index, occupied); }	// [9]  Function to find the squares a queen attacks
+inline bitboard between(int index_1, int index_2) { return between_table[index_1][index_2]; }									// [10] Function to find the squares strictly between two squares on the same line, or no squares if they don't share a line
+inline bitboard line(int index_1, int index_2) { return line_table[index_1][index_2]; }											// [11] Function to find the whole line (edge to edge) through two squares, or no squares if they don't share a line
+bool square_attacked(const position &p, int index, colour attacking_colour);													// [12] Function to check if any piece of a team attacks a square
+bitboard attackers_to(const position &p, int index, colour attacking_colour, bitboard occupied);								// [13] Function to find every piece of a team that attacks a square, with the given squares treated as occupied
+bitboard team_attacks(const position &p, colour attacking_colour);																// [14] Function to find every square attacked by any piece of a team
+bitboard pinned_pieces(const position &p, colour king_colour);																	// [15] Function to find the pieces of a team that are pinned to their own king
+
+template<piece_index type> inline bitboard attacks(int index, bitboard occupied);												// [16] Function template to find the squares attacked by a piece of one type, the specialisations are the
+template<> inline bitboard attacks<knight_index>(int index, bitboard) { return knight_attacks(index); }							//      movement rules of each piece (pawns attack differently for each team so they use pawn_attacks)
+template<> inline bitboard attacks<bishop_index>(int index, bitboard occupied) { return bishop_attacks(index, occupied); }
+template<> inline bitboard attacks<rook_index>(int index, bitboard occupied) { return rook_attacks(index, occupied); }
+template<> inline bitboard attacks<queen_index>(int index, bitboard occupied) { return queen_attacks(index, occupied); }
+template<> inline bitboard attacks<king_index>(int index, bitboard) { return king_attacks(index); }
+
+inline bitboard piece_attacks(colour piece_colour, piece_index type, int index, bitboard occupied) {							// [17] Function to find the squares attacked by a piece whose type is only known when the program runs
+	switch (type) {
+	case pawn_index:	return pawn_attacks(piece_colour, index);
+	case knight_index:	return attacks<knight_index>(index, occupied);
+	case bishop_index:	return attacks<bishop_index>(index, occupied);
+	case rook_index:	return attacks<rook_index>(index, occupied);
+	case queen_index:	return attacks<queen_index>(index, occupied);
+	default:			return attacks<king_index>(index, occupied);
+	}
+}
+
+#endif
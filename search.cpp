@@ -0,0 +1,255 @@
+// search.cpp implements the functions defined in the search.h header file
+
+#include "search.h"
+#include "piece_attacks.h"
+#include <thread>
+
+namespace {
+	// Mate scores count the moves from the root of the search, but a position in the transposition table can be reached at any ply, so mate scores are
+	// stored counting from the position itself and changed back when they are read
+	int score_to_table(int score, int ply)
+	{
+		if (score >= mate_score - max_search_depth) return score + ply;
+		if (score <= -mate_score + max_search_depth) return score - ply;
+		return score;
+	}
+
+	int score_from_table(int score, int ply)
+	{
+		if (score >= mate_score - max_search_depth) return score - ply;
+		if (score <= -mate_score + max_search_depth) return score + ply;
+		return score;
+	}
+
+	// Function to score a position at the end of the search, with the network if the search has one (its accumulator for the ply is already up to date)
+	int static_score(const nnue_network *network, const nnue_accumulator &accumulator, const board &chessboard, colour team_colour)
+	{
+		return network != nullptr ? network->evaluate(accumulator, team_colour) : evaluate(chessboard, team_colour);
+	}
+}
+
+// SEARCH_ENGINE CLASS
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// [2]  Function to stop the search if the node or time budget has run out or another thread has asked it to stop. Reading the clock is slow compared to
+//      visiting a node, so the time is only looked at once every 1024 nodes
+
+void search_engine::check_limits() {
+	if (stop_signal != nullptr && stop_signal->load(std::memory_order_relaxed) == true) stopped = true;
+	if (limits.max_nodes != 0 && nodes >= limits.max_nodes) stopped = true;
+	if (limits.max_seconds > 0 && (nodes & 1023) == 0) {
+		if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count() >= limits.max_seconds) stopped = true;
+	}
+}
+
+// [3]  Function to search a position to a depth and return its score for the team to move. Each move is made in place, the position after it is scored
+//      for the other team and that score negated is the score of the move. alpha is the score the team to move is already sure of and beta is the score
+//      the opponent is already sure of, so a move scoring beta or more will never be allowed by the opponent and the rest of the moves needn't be searched.
+//      The transposition table is looked at first, a result from at least as deep a search whose bound settles the score is returned without searching
+
+int search_engine::negamax(board &chessboard, colour team_colour, int depth, int ply, int alpha, int beta) {
+	pv_length[ply] = ply;
+	nodes++;
+	check_limits();
+	if (stopped == true) return 0;
+	//a position that has been reached before in the game or the search is scored as a draw, since the side that is worse off can repeat it again and
+	//again, and so is a position where the fifty move rule can be claimed
+	if (ply > 0 && (chessboard.halfmoves() >= 100 || chessboard.repetitions() > 0)) return 0;
+	if (ply >= max_search_depth - 1) return static_score(network, accumulators[ply], chessboard, team_colour);
+	if (depth <= 0) return quiescence(chessboard, team_colour, ply, alpha, beta);
+
+	tt_entry stored{ chess_move(0, 0), 0, 0, no_bound };
+	if (table != nullptr && table->probe(chessboard.hash_key(), stored) == true && ply > 0 && stored.depth >= depth) {
+		int score = score_from_table(stored.score, ply);
+		if (stored.bound == exact_bound || (stored.bound == lower_bound && score >= beta) || (stored.bound == upper_bound && score <= alpha)) return score;
+	}
+	int original_alpha = alpha;
+
+	//the hash move is searched first, or the move of the last principal variation if the table has no move, and the picker hands out the rest
+	chess_move hash_move = stored.move;
+	if (pack_move(hash_move) == 0 && ply < previous_pv_length) hash_move = previous_pv[ply];
+	move_picker picker(chessboard, team_colour, hash_move, killers[ply], &history[team_colour]);
+
+	int best_score = -infinite_score; chess_move best_move(0, 0);
+	int legal_moves = 0;
+	chess_move m;
+	while (picker.next_move(m) == true) {
+		legal_moves++;
+		bool quiet = is_quiet(chessboard, m);
+		move_undo undo = chessboard.make_move(m);
+		if (network != nullptr) network->update(accumulators[ply], accumulators[ply + 1], undo, chessboard.get_position());
+		int score = -negamax(chessboard, opposite_colour(team_colour), depth - 1, ply + 1, -beta, -alpha);
+		chessboard.unmake_move(undo);
+		if (stopped == true) return 0;
+
+		if (score > best_score) {
+			best_score = score; best_move = m;
+			if (score > alpha) { //the best line from this ply is this move followed by the best line from the next ply
+				alpha = score;
+				pv_table[ply][ply] = m;
+				for (int next = ply + 1; next < pv_length[ply + 1]; next++) pv_table[ply][next] = pv_table[ply + 1][next];
+				pv_length[ply] = pv_length[ply + 1];
+				if (alpha >= beta) { //the opponent won't allow this position, so the other moves don't matter
+					if (quiet == true) record_cut_off(m, team_colour, depth, ply);
+					break;
+				}
+			}
+		}
+	}
+	if (legal_moves == 0) { //no legal moves is check mate if the king is in check and stale mate if it isn't
+		return chessboard.checking_pieces(team_colour) != 0 ? -mate_score + ply : 0;
+	}
+
+	if (table != nullptr) { //a score above beta is only a lower bound (the rest of the moves weren't searched) and a score that never raised alpha is an upper bound
+		score_bound bound = best_score >= beta ? lower_bound : (best_score > original_alpha ? exact_bound : upper_bound);
+		table->store(chessboard.hash_key(), tt_entry{ bound == upper_bound ? chess_move(0, 0) : best_move, score_to_table(best_score, ply), depth, bound });
+	}
+	return best_score;
+}
+
+// [4]  Function to search only the captures and promotions at the end of the main search, so a position isn't scored in the middle of an exchange (a
+//      queen that has just taken a pawn defended by another pawn would otherwise count as a pawn up). The team to move may "stand pat" and take the
+//      evaluation as it is, since it doesn't have to take anything, so the search only goes on while a capture can do better. Captures that the
+//      static exchange evaluation says lose material are skipped. A team in check can't stand pat, so every move out of check is searched and no
+//      moves at all is check mate
+
+int search_engine::quiescence(board &chessboard, colour team_colour, int ply, int alpha, int beta) {
+	pv_length[ply] = ply;
+	nodes++;
+	check_limits();
+	if (stopped == true) return 0;
+	if (ply > 0 && chessboard.halfmoves() >= 100) return 0;
+	bool in_check = chessboard.checking_pieces(team_colour) != 0;
+	int best_score = -infinite_score;
+	if (in_check == false) {
+		best_score = static_score(network, accumulators[ply], chessboard, team_colour);
+		if (best_score >= beta || ply >= max_search_depth - 1) return best_score;
+		if (best_score > alpha) alpha = best_score;
+	}
+	else if (ply >= max_search_depth - 1) return static_score(network, accumulators[ply], chessboard, team_colour);
+
+	move_picker picker(chessboard, team_colour, chess_move(0, 0), nullptr, nullptr, in_check == false);
+	int legal_moves = 0;
+	chess_move m;
+	while (picker.next_move(m) == true) {
+		legal_moves++;
+		if (in_check == false && m.promotion == no_promotion && static_exchange(chessboard, m) < 0) continue; //a losing capture can't beat standing pat
+		move_undo undo = chessboard.make_move(m);
+		if (network != nullptr) network->update(accumulators[ply], accumulators[ply + 1], undo, chessboard.get_position());
+		int score = -quiescence(chessboard, opposite_colour(team_colour), ply + 1, -beta, -alpha);
+		chessboard.unmake_move(undo);
+		if (stopped == true) return 0;
+
+		if (score > best_score) {
+			best_score = score;
+			if (score > alpha) {
+				alpha = score;
+				if (alpha >= beta) break;
+			}
+		}
+	}
+	if (in_check == true && legal_moves == 0) return -mate_score + ply;
+	return best_score;
+}
+
+// [5]  Function to remember a quiet move that caused a cut off. It becomes the first killer move of its ply (the old first killer becomes the second) and its
+//      history score goes up by the depth squared, so cut offs near the root, which save the most work, count the most. When a score gets large every
+//      score is halved, which keeps them in range and lets newer cut offs outweigh old ones
+
+void search_engine::record_cut_off(const chess_move &m, colour team_colour, int depth, int ply) {
+	if ((m == killers[ply][0]) == false) { killers[ply][1] = killers[ply][0]; killers[ply][0] = m; }
+	int &score = history[team_colour][m.from][m.to];
+	score += depth * depth;
+	if (score > (1 << 20)) {
+		for (int team = 0; team < 2; team++) {
+			for (int from = 0; from < 64; from++) for (int to = 0; to < 64; to++) history[team][from][to] /= 2;
+		}
+	}
+}
+
+// [6]  Parameterised search_engine constructor, the transposition table is optional and may be shared with other searches
+
+search_engine::search_engine(transposition_table *shared_table)
+	: table{ shared_table }, nodes{ 0 }, stopped{ false }, stop_signal{ nullptr }, thread_number{ 0 }, previous_pv_length{ 0 }, killers{}, history{},
+	network{ nullptr } {}
+
+// [10] Function to search with iterative deepening until the budget runs out. If the budget runs out part way through a depth, the result of the last
+//      finished depth is kept (the part searched might not have looked at the best move yet), unless not even depth 1 was finished. Helper threads of a
+//      parallel search with an odd thread number start one depth deeper, so at any time the threads are spread over two depths. The caller starts the new
+//      search in the transposition table with new_search, since the table's age must not change while other threads are using it
+
+search_result search_engine::find_best_move(board &chessboard, colour team_colour, const search_limits &search_budget,
+	const std::function<void(const search_result &)> &report_iteration) {
+	limits = search_budget; nodes = 0; stopped = false; previous_pv_length = 0;
+	for (int ply = 0; ply < max_search_depth; ply++) killers[ply][0] = killers[ply][1] = chess_move(0, 0); //killer moves belong to the positions of one search
+	start_time = std::chrono::steady_clock::now();
+	if (network != nullptr) network->refresh(chessboard.get_position(), accumulators[0]); //the only full refresh, every other ply is updated from the ply before
+	search_result result;
+
+	move_list root_moves;
+	chessboard.generate_legal_moves(team_colour, root_moves);
+	if (root_moves.size() == 0) { //the game is already over, there is no move to find
+		result.score = chessboard.checking_pieces(team_colour) != 0 ? -mate_score : 0;
+		return result;
+	}
+	result.best_move = root_moves[0]; //a legal move to fall back on if the budget runs out before depth 1 finishes
+
+	for (int depth = 1 + (thread_number & 1); depth <= limits.max_depth && depth < max_search_depth; depth++) {
+		int score = negamax(chessboard, team_colour, depth, 0, -infinite_score, infinite_score);
+		result.nodes = nodes;
+		result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+		if (stopped == true) break;
+
+		result.score = score; result.depth = depth;
+		result.pv_length = pv_length[0];
+		for (int ply = 0; ply < pv_length[0]; ply++) result.principal_variation[ply] = previous_pv[ply] = pv_table[0][ply];
+		previous_pv_length = pv_length[0];
+		if (pv_length[0] > 0) result.best_move = pv_table[0][0];
+		if (report_iteration) report_iteration(result);
+		if (score >= mate_score - max_search_depth || score <= -mate_score + max_search_depth) break; //a forced mate was found, searching deeper can't improve on it
+	}
+	return result;
+}
+
+// [11] Function to search with a number of threads sharing one transposition table (Lazy SMP). Every thread gets its own copy of the board, which is a plain
+//      value, so the threads share nothing but the table. Thread 0 is the main search and keeps to the budget, the helper threads search until thread 0
+//      finishes and then are told to stop. The result is the deepest one found (thread 0's if there is a tie) with the nodes of every thread added up, and
+//      the nodes searched by each thread are put in thread_nodes. Setting stop_signal (if given) stops thread 0 at its next node, and the helpers with it
+
+search_result parallel_search(const board &chessboard, colour team_colour, const search_limits &search_budget, transposition_table &table,
+	int number_of_threads, std::vector<unsigned long long> &thread_nodes, const std::function<void(const search_result &)> &report_iteration,
+	const nnue_network *network, const std::atomic<bool> *stop_signal)
+{
+	if (number_of_threads < 1) number_of_threads = 1;
+	std::atomic<bool> stop_helpers{ false };
+	std::vector<search_result> results(number_of_threads);
+	table.new_search(); //before any thread starts, so every entry of this search is stored with its age
+	std::vector<std::thread> helpers;
+
+	search_limits helper_limits = search_budget; helper_limits.max_nodes = 0; helper_limits.max_seconds = 0; //the helpers stop when the main thread does
+	for (int number = 1; number < number_of_threads; number++) {
+		helpers.emplace_back([&, number]() {
+			board thread_board = chessboard;
+			search_engine helper(&table);
+			helper.set_stop_signal(&stop_helpers); helper.set_thread_number(number); helper.set_network(network);
+			results[number] = helper.find_best_move(thread_board, team_colour, helper_limits);
+		});
+	}
+
+	board main_board = chessboard;
+	search_engine main_search(&table);
+	main_search.set_network(network); main_search.set_stop_signal(stop_signal);
+	results[0] = main_search.find_best_move(main_board, team_colour, search_budget, report_iteration);
+	stop_helpers.store(true, std::memory_order_relaxed);
+	for (std::thread &helper : helpers) helper.join();
+
+	search_result best = results[0];
+	thread_nodes.assign(number_of_threads, 0);
+	unsigned long long total_nodes = 0;
+	for (int number = 0; number < number_of_threads; number++) {
+		thread_nodes[number] = results[number].nodes;
+		total_nodes += results[number].nodes;
+		if (results[number].depth > best.depth && results[number].pv_length > 0) best = results[number];
+	}
+	best.nodes = total_nodes; best.seconds = results[0].seconds;
+	return best;
+}
@@ -0,0 +1,89 @@
+// search.h declares the search_engine class which finds the best move for a team. It is a negamax alpha-beta search: every position is scored from the point of
+// view of the team to move, so a score for one team is the negative of the score for the other and the same function searches for both teams. Branches
+// which can't change the result (a move the opponent would never allow) are cut off using the alpha and beta bounds. The search is run with iterative
+// deepening, searching to depth 1, then 2, then 3 and so on until the node or time budget runs out, and the principal variation (the line of best play
+// found by the last finished depth) is searched first at the next depth, which makes the cut offs happen much sooner. The other moves are handed out by a
+// move_picker (see move_picker.h) in stages: captures by MVV-LVA, then killer moves, then quiet moves by their history score. When the depth runs out a
+// quiescence search carries on with the captures and promotions alone (leaving out captures the static exchange evaluation says lose material) until
+// the position is quiet, and quiet positions are scored by the evaluation (see evaluation.h) in hundredths of a pawn, or by a neural network (see
+// nnue.h) when the search is given one, whose accumulators are kept in a stack with one entry for each ply. When the search is
+// given a transposition table, every position searched is stored in it and a position found there with a deep enough result isn't searched again.
+// parallel_search runs a "Lazy SMP" search: several threads each search the same position with their own copy of the board and share only the
+// transposition table, so each thread finds the results the others have stored and they spread out over different parts of the tree
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "board_and_players.h"
+#include "evaluation.h"
+#include "move_picker.h"
+#include "nnue.h"
+#include "transposition.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+const int max_search_depth = 64;		// The deepest the search will go, this also bounds the length of the principal variation
+const int infinite_score = 32000;		// A score outside the range of any real score, used as the starting alpha-beta window
+const int mate_score = 30000;			// The score of giving check mate now, a mate n moves away scores mate_score - n so faster mates score higher
+
+																																// SEARCH_LIMITS STRUCT
+struct search_limits {																											//--------------------------------------------------------------------------------------------------------
+	int max_depth = max_search_depth;				// The deepest iteration to search to
+	unsigned long long max_nodes = 0;				// The number of nodes to stop after, 0 for no limit
+	double max_seconds = 0;							// The time to stop after, 0 for no limit
+};
+
+																																// SEARCH_RESULT STRUCT
+struct search_result {																											//--------------------------------------------------------------------------------------------------------
+	chess_move best_move{ 0, 0 };					// The best move found, from and to are both 0 if the team has no legal moves
+	int score = 0;									// The score of the best move in hundredths of a pawn for the team that moves
+	int depth = 0;									// The last depth that was searched all the way through
+	unsigned long long nodes = 0;					// The number of positions visited
+	double seconds = 0;								// The time taken
+	chess_move principal_variation[max_search_depth];	// The line of best play for both teams starting with best_move
+	int pv_length = 0;
+
+	double nodes_per_second() const { return seconds > 0 ? nodes / seconds : 0; }												// [1]  Function to work out the speed of the search
+};
+
+																																// SEARCH_ENGINE CLASS
+class search_engine																											//--------------------------------------------------------------------------------------------------------
+{
+private:
+	transposition_table *table;						// The transposition table shared with any other searches, or nullptr to search without one
+	search_limits limits;							// The budget of the current search
+	std::chrono::steady_clock::time_point start_time;	// When the current search started
+	unsigned long long nodes;						// The number of positions visited so far
+	bool stopped;									// Set once the budget runs out, every level of the search then returns straight away
+	const std::atomic<bool> *stop_signal;			// Set by another thread to stop this search, or nullptr if nothing else can stop it
+	int thread_number;								// 0 for the main search, helper threads of a parallel search are numbered from 1
+	chess_move pv_table[max_search_depth][max_search_depth];	// Triangular table of principal variations, row "ply" is the best line found from that ply
+	int pv_length[max_search_depth];
+	chess_move previous_pv[max_search_depth];		// The principal variation of the last finished depth, tried first at the next depth
+	int previous_pv_length;
+	chess_move killers[max_search_depth][2];		// The last two quiet moves to cause a cut off at each ply
+	history_table history[2];						// The history score of every quiet move of each team, raised by depth squared whenever the move causes a cut off
+	const nnue_network *network;					// The network that scores the positions at the end of the search, or nullptr to use the hand written evaluation
+	nnue_accumulator accumulators[max_search_depth];	// The network's accumulator of the position at each ply, each worked out from the one before it
+
+	void check_limits();																										// [2]  Function to stop the search if the node or time budget has run out
+	int negamax(board &chessboard, colour team_colour, int depth, int ply, int alpha, int beta);								// [3]  Function to search a position to a depth and return its score for the team to move
+	int quiescence(board &chessboard, colour team_colour, int ply, int alpha, int beta);										// [4]  Function to search the captures and promotions of a position until it is quiet
+	void record_cut_off(const chess_move &m, colour team_colour, int depth, int ply);											// [5]  Function to remember a quiet move that caused a cut off as a killer move and in the history table
+public:
+	search_engine(transposition_table *shared_table = nullptr);																	// [6]  Parameterised search_engine constructor
+	void set_stop_signal(const std::atomic<bool> *signal) { stop_signal = signal; }												// [7]  Function to give the search a flag that another thread sets to stop it
+	void set_thread_number(int number) { thread_number = number; }																// [8]  Function to make the search a helper thread of a parallel search
+	void set_network(const nnue_network *weights) { network = weights; }														// [9]  Function to score positions with a neural network instead of the hand written evaluation
+
+	search_result find_best_move(board &chessboard, colour team_colour, const search_limits &search_budget,						// [10] Function to search with iterative deepening until the budget runs out, calling
+		const std::function<void(const search_result &)> &report_iteration = nullptr);											//      report_iteration after each finished depth
+};
+
+search_result parallel_search(const board &chessboard, colour team_colour, const search_limits &search_budget, transposition_table &table,	// [11] Function to search with a number of threads sharing
+	int number_of_threads, std::vector<unsigned long long> &thread_nodes, const std::function<void(const search_result &)> &report_iteration = nullptr,
+	const nnue_network *network = nullptr, const std::atomic<bool> *stop_signal = nullptr);	//      one transposition table
+
+#endif
@@ -0,0 +1,431 @@
+// selfplay.cpp is a tournament harness which plays two engine settings against each other, to show whether a change to the board or the search turns
+// into playing strength and not just into speed. The games are played concurrently, one on each core, each worker thread playing whole games on its own
+// boards with its own search engines and transposition tables, so the games share nothing but the queue of game numbers and the tally of results. Each
+// opening (read from a file of FENs, or made by playing a few random moves from the start position) is played twice with the colours swapped, so neither
+// setting gains from a lucky opening. A game ends by checkmate, stalemate, the fifty move rule, threefold repetition or insufficient material, or is
+// adjudicated: a win once both engines agree for some moves that one team is far ahead, a draw once both agree for some moves that the score is level,
+// and a draw at the move limit. The result of the match is given as wins, draws and losses of engine A, its Elo difference with a 95% error bar and the
+// likelihood of superiority, and with --sprt the log likelihood ratio of a sequential probability ratio test between two Elo hypotheses, which stops
+// the match as soon as either hypothesis is accepted. The speed of the harness is given as games per second and nodes per second, and the time each
+// engine took to choose a move as percentiles
+//
+// Usage:	selfplay [options]
+//			--games N						the number of games to play (100 by default), rounded up to an even number so each opening is played by both sides
+//			--concurrency N					the number of games played at once (one for each core by default)
+//			--openings FILE					play the openings in a file, one FEN per line (blank lines and lines starting with # are skipped), in turn
+//			--random-plies N				without an openings file, start each opening with N random moves from the start position (8 by default)
+//			--seed N						the seed of the random openings
+//			--a SETTINGS, --b SETTINGS		the settings of engine A and engine B, a comma separated list of nodes=N (nodes per move), depth=N,
+//											movetime=MS, hash=MB and eval=FILE (a network weights file, see nnue.h), e.g. "nodes=20000,eval=net.bin".
+//											Both search 10000 nodes per move with 8 MB of hash and the hand written evaluation by default
+//			--resign SCORE MOVES			adjudicate a win once both engines score the game at least SCORE for MOVES moves each (1000 and 4 by default, 0 turns it off)
+//			--draw SCORE MOVES PLY			adjudicate a draw once both engines score the game within SCORE of level for MOVES moves each from ply PLY on
+//											(10, 8 and 80 by default, 0 moves turns it off)
+//			--max-plies N					adjudicate a draw after N plies (400 by default)
+//			--sprt ELO0 ELO1 [ALPHA BETA]	test whether engine A is ELO0 or ELO1 stronger than engine B, stopping once the test decides (alpha and beta are 0.05 by default)
+//			--pgn FILE						write every game to a PGN file, which can be checked with "chess --pgn FILE"
+
+#include "pgn.h"
+#include "piece_attacks.h"
+#include "search.h"
+#include "zobrist.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	// The settings of one of the two engines, the network is loaded once and shared by every worker since evaluating doesn't change it
+	struct engine_settings {
+		std::string name;
+		search_limits limits;
+		int hash_megabytes = 8;
+		std::string eval_file;
+		std::unique_ptr<nnue_network> network;
+	};
+
+	// The settings of the whole match
+	struct match_settings {
+		int games = 100;
+		int concurrency = int(std::max(1u, std::thread::hardware_concurrency()));
+		std::vector<std::string> openings;			// The FENs of the openings file, or empty to make random openings
+		int random_plies = 8;
+		std::uint64_t seed = 1;
+		engine_settings engines[2];					// Engine A then engine B
+		int resign_score = 1000, resign_moves = 4;
+		int draw_score = 10, draw_moves = 8, draw_from_ply = 80;
+		int max_plies = 400;
+		bool sprt = false;
+		double elo0 = 0, elo1 = 5, alpha = 0.05, beta = 0.05;
+		std::string pgn_file;
+	};
+
+	// What each worker measures of the searches, merged once the match is over so the workers never share a counter while playing
+	struct search_measurements {
+		std::vector<float> move_milliseconds[2];	// The time each search took, for each engine
+		unsigned long long nodes[2] = { 0, 0 };
+		double seconds[2] = { 0, 0 };
+		unsigned long long moves[2] = { 0, 0 };
+	};
+
+	// Everything the workers share: the next game to play and the tally, which is only touched under the lock once a game is over
+	struct match_state {
+		const match_settings &settings;
+		std::atomic<int> next_game{ 0 };
+		std::atomic<bool> stop{ false };			// Set once the SPRT has decided, the workers finish the games they are playing and start no more
+		std::mutex result_lock;
+		unsigned long long wins = 0, draws = 0, losses = 0;		// Engine A's results
+		unsigned long long plies = 0;
+		int games_played = 0;
+		std::vector<std::string> reasons;			// How each kind of game ended, with reason_counts
+		std::vector<int> reason_counts;
+		std::ofstream pgn;
+		std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+		explicit match_state(const match_settings &s) : settings{ s } {}
+	};
+
+	// Function to read one engine's settings from a comma separated list of name=value pairs, returns false if one can't be read
+	bool read_engine_settings(const std::string &text, engine_settings &engine)
+	{
+		std::stringstream items(text);
+		std::string item;
+		while (std::getline(items, item, ',')) {
+			std::size_t equals = item.find('=');
+			if (equals == std::string::npos) return false;
+			std::string name = item.substr(0, equals), value = item.substr(equals + 1);
+			long long number = std::atoll(value.c_str());
+			if (name == "nodes" && number >= 0) engine.limits.max_nodes = (unsigned long long)number;
+			else if (name == "depth" && number > 0) engine.limits.max_depth = int(std::min<long long>(number, max_search_depth));
+			else if (name == "movetime" && number >= 0) engine.limits.max_seconds = number / 1000.0;
+			else if (name == "hash" && number > 0) engine.hash_megabytes = int(number);
+			else if (name == "eval") engine.eval_file = value;
+			else return false;
+		}
+		return true;
+	}
+
+	// Function to find whether neither team has the pieces left to give checkmate: kings alone, or a king and one knight or bishop against a king
+	bool insufficient_material(const position &p)
+	{
+		for (colour team_colour : { black, white }) {
+			if (p.piece_sets[team_colour][pawn_index] | p.piece_sets[team_colour][rook_index] | p.piece_sets[team_colour][queen_index]) return false;
+		}
+		bitboard minor_pieces = p.piece_sets[black][knight_index] | p.piece_sets[black][bishop_index] | p.piece_sets[white][knight_index] | p.piece_sets[white][bishop_index];
+		return count_squares(minor_pieces) <= 1;
+	}
+
+	// Function to set up the board of an opening: the FEN of the openings file in turn, or random moves from the start position chosen by the seed and the
+	// opening's number (an opening whose random moves end the game is made again with the next seed). Returns false if the FEN can't be read
+	bool set_up_opening(const match_settings &settings, int opening_number, board &chessboard)
+	{
+		if (settings.openings.empty() == false) return chessboard.from_fen(settings.openings[std::size_t(opening_number) % settings.openings.size()]);
+		std::uint64_t seed = settings.seed * 0x9E3779B97F4A7C15ULL + std::uint64_t(opening_number);
+		for (;;) {
+			chessboard = board();
+			bool game_over = false;
+			for (int ply = 0; ply < settings.random_plies && game_over == false; ply++) {
+				move_list moves;
+				chessboard.generate_legal_moves(chessboard.team_to_move(), moves);
+				chessboard.make_move(moves[int(next_random(seed) % std::uint64_t(moves.size()))]);
+				game_over = chessboard.game_status() != game_in_play;
+			}
+			if (game_over == false) return true;
+		}
+	}
+
+	// Function to play one game from an opening, engine A playing white if a_plays_white is set. The moves are written in SAN to the game's movetext as
+	// they are played, the result is returned from white's side ("1-0", "0-1" or "1/2-1/2") and how the game ended is put in reason
+	std::string play_game(const match_settings &settings, const engine_settings *players[2], search_engine *engines[2], transposition_table *tables[2],
+		board &chessboard, search_measurements &measured, const int engine_numbers[2], std::string &movetext, int &plies, std::string &reason)
+	{
+		int resign_count = 0, draw_count = 0;
+		colour resign_winner = white;
+		for (plies = 0;; plies++) {
+			colour team_colour = chessboard.team_to_move();
+			switch (chessboard.game_status()) {
+			case game_checkmate:		reason = "checkmate"; return team_colour == white ? "0-1" : "1-0";
+			case game_stalemate:		reason = "stalemate"; return "1/2-1/2";
+			case game_fifty_move_draw:	reason = "fifty move rule"; return "1/2-1/2";
+			case game_repetition_draw:	reason = "threefold repetition"; return "1/2-1/2";
+			default:					break;
+			}
+			if (insufficient_material(chessboard.get_position())) { reason = "insufficient material"; return "1/2-1/2"; }
+			if (plies >= settings.max_plies) { reason = "move limit"; return "1/2-1/2"; }
+
+			int engine_number = engine_numbers[team_colour];
+			tables[team_colour]->new_search();
+			search_result result = engines[team_colour]->find_best_move(chessboard, team_colour, players[team_colour]->limits);
+			measured.move_milliseconds[engine_number].push_back(float(result.seconds * 1000));
+			measured.nodes[engine_number] += result.nodes; measured.seconds[engine_number] += result.seconds; measured.moves[engine_number]++;
+
+			if (movetext.empty() == false) movetext += ' ';
+			if (team_colour == white) movetext += std::to_string(chessboard.move_number()) + ". ";
+			else if (plies == 0) movetext += std::to_string(chessboard.move_number()) + "... ";
+			char san[8];
+			movetext.append(san, std::size_t(write_san(chessboard, result.best_move, san)));
+			chessboard.make_move(result.best_move);
+
+			//Adjudication: the score is for the team that moved, so a win needs it to stay high for one team and low for the other in turn
+			if (settings.resign_moves > 0 && std::abs(result.score) >= settings.resign_score) {
+				colour winner = result.score > 0 ? team_colour : opposite_colour(team_colour);
+				resign_count = (resign_count > 0 && winner == resign_winner) ? resign_count + 1 : 1;
+				resign_winner = winner;
+				if (resign_count >= 2 * settings.resign_moves) { plies++; reason = "adjudicated win"; return resign_winner == white ? "1-0" : "0-1"; }
+			}
+			else resign_count = 0;
+			if (settings.draw_moves > 0 && plies >= settings.draw_from_ply && std::abs(result.score) <= settings.draw_score) {
+				if (++draw_count >= 2 * settings.draw_moves) { plies++; reason = "adjudicated draw"; return "1/2-1/2"; }
+			}
+			else draw_count = 0;
+		}
+	}
+
+	// Function to add a finished game to the tally and the PGN file, and print a progress line every so often
+	void record_game(match_state &match, int game_number, bool a_plays_white, const std::string &opening_fen, const std::string &result,
+		const std::string &reason, int plies, const std::string &movetext)
+	{
+		const match_settings &settings = match.settings;
+		std::lock_guard<std::mutex> lock(match.result_lock);
+		if (result == "1/2-1/2") match.draws++;
+		else if ((result == "1-0") == a_plays_white) match.wins++;
+		else match.losses++;
+		match.plies += (unsigned long long)plies;
+		match.games_played++;
+		std::size_t kind = std::size_t(std::find(match.reasons.begin(), match.reasons.end(), reason) - match.reasons.begin());
+		if (kind == match.reasons.size()) { match.reasons.push_back(reason); match.reason_counts.push_back(0); }
+		match.reason_counts[kind]++;
+
+		if (match.pgn.is_open()) {
+			const std::string &white_name = settings.engines[a_plays_white ? 0 : 1].name, &black_name = settings.engines[a_plays_white ? 1 : 0].name;
+			match.pgn << "[Event \"Self-play\"]\n[Round \"" << game_number + 1 << "\"]\n[White \"" << white_name << "\"]\n[Black \"" << black_name
+				<< "\"]\n[Result \"" << result << "\"]\n[SetUp \"1\"]\n[FEN \"" << opening_fen << "\"]\n[PlyCount \"" << plies << "\"]\n[Termination \""
+				<< reason << "\"]\n\n" << movetext << (movetext.empty() ? "" : " ") << result << "\n\n";
+		}
+		if (match.games_played % 100 == 0) {
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - match.start_time).count();
+			std::cout << "Games " << match.games_played << "  A +" << match.wins << " =" << match.draws << " -" << match.losses << "  " << std::fixed
+				<< std::setprecision(1) << match.games_played / seconds << " games/s" << std::endl;
+		}
+	}
+
+	// Function to find the Elo difference that gives an expected score
+	double elo_difference(double score) { return -400.0 * std::log10(1.0 / score - 1.0); }
+
+	// Function to find the expected score of an Elo difference
+	double expected_score(double elo) { return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0)); }
+
+	// Function to work out the log likelihood ratio of the hypotheses that engine A is elo1 rather than elo0 stronger, using the normal approximation of
+	// the generalised SPRT: with the mean score s and its variance per game var over n games, LLR = n (s1 - s0)(2s - s0 - s1) / (2 var). Half a win, a
+	// draw and half a loss are added to the results, so the first few games can't decide the test and a match of nothing but wins still has a variance
+	double sprt_llr(unsigned long long wins, unsigned long long draws, unsigned long long losses, double elo0, double elo1)
+	{
+		if (wins + draws + losses == 0) return 0;
+		double w = wins + 0.5, d = draws + 1.0, l = losses + 0.5, n = w + d + l;
+		double s = (w + d * 0.5) / n;
+		double variance = (w * (1 - s) * (1 - s) + d * (0.5 - s) * (0.5 - s) + l * s * s) / n;
+		double s0 = expected_score(elo0), s1 = expected_score(elo1);
+		return n * (s1 - s0) * (2 * s - s0 - s1) / (2 * variance);
+	}
+
+	// Function run by each worker thread: take the next pair of game numbers until the match is over, both games of a pair playing the same opening. The
+	// engines and tables are the worker's own, the tables are emptied and the engines made afresh for each game so no game depends on the one before
+	void run_worker(match_state &match, search_measurements &measured)
+	{
+		const match_settings &settings = match.settings;
+		transposition_table tables[2] = { transposition_table(std::size_t(settings.engines[0].hash_megabytes)), transposition_table(std::size_t(settings.engines[1].hash_megabytes)) };
+		std::unique_ptr<search_engine> engines[2];
+		board opening, chessboard;
+		char fen[max_fen_length];
+		std::string movetext, reason;
+		for (int game_number; match.stop.load(std::memory_order_relaxed) == false && (game_number = match.next_game.fetch_add(1)) < settings.games;) {
+			if (set_up_opening(settings, game_number / 2, opening) == false) {
+				std::cerr << "Can't read the opening " << settings.openings[std::size_t(game_number / 2) % settings.openings.size()] << std::endl;
+				match.stop = true;
+				return;
+			}
+			opening.to_fen(fen);
+			bool a_plays_white = game_number % 2 == 0;
+			for (int e = 0; e < 2; e++) {
+				tables[e].clear();
+				engines[e] = std::make_unique<search_engine>(&tables[e]);
+				engines[e]->set_network(settings.engines[e].network.get());
+			}
+			const int engine_numbers[2] = { a_plays_white ? 1 : 0, a_plays_white ? 0 : 1 }; //indexed by [colour]
+			const engine_settings *players[2] = { &settings.engines[engine_numbers[black]], &settings.engines[engine_numbers[white]] };
+			search_engine *playing[2] = { engines[engine_numbers[black]].get(), engines[engine_numbers[white]].get() };
+			transposition_table *playing_tables[2] = { &tables[engine_numbers[black]], &tables[engine_numbers[white]] };
+
+			chessboard = opening; movetext.clear();
+			int plies = 0;
+			std::string result = play_game(settings, players, playing, playing_tables, chessboard, measured, engine_numbers, movetext, plies, reason);
+			record_game(match, game_number, a_plays_white, fen, result, reason, plies, movetext);
+
+			if (settings.sprt == true) {
+				std::lock_guard<std::mutex> lock(match.result_lock);
+				double llr = sprt_llr(match.wins, match.draws, match.losses, settings.elo0, settings.elo1);
+				if (llr <= std::log(settings.beta / (1 - settings.alpha)) || llr >= std::log((1 - settings.beta) / settings.alpha)) match.stop = true;
+			}
+		}
+	}
+
+	// Function to find a percentile of a set of times, which is reordered
+	float percentile(std::vector<float> &times, double fraction)
+	{
+		if (times.empty()) return 0;
+		std::size_t index = std::min(times.size() - 1, std::size_t(fraction * double(times.size())));
+		std::nth_element(times.begin(), times.begin() + std::ptrdiff_t(index), times.end());
+		return times[index];
+	}
+
+	// Function to print the result of the match, its Elo and SPRT statistics and the speed of the harness and of each engine
+	void print_results(match_state &match, std::vector<search_measurements> &measured, double seconds)
+	{
+		const match_settings &settings = match.settings;
+		unsigned long long wins = match.wins, draws = match.draws, losses = match.losses, n = wins + draws + losses;
+		std::cout << "\n" << settings.engines[0].name << " vs " << settings.engines[1].name << ": " << n << " games, A +" << wins << " =" << draws << " -" << losses << std::endl;
+		std::cout << "  ended by:";
+		for (std::size_t kind = 0; kind < match.reasons.size(); kind++) std::cout << (kind > 0 ? ", " : " ") << match.reasons[kind] << " " << match.reason_counts[kind];
+		std::cout << std::endl;
+
+		if (n > 0) {
+			double s = (wins + draws * 0.5) / double(n);
+			double variance = (wins * (1 - s) * (1 - s) + draws * (0.5 - s) * (0.5 - s) + losses * s * s) / double(n);
+			double margin = 1.959964 * std::sqrt(variance / double(n)); //95% of the normal distribution of the mean score
+			std::cout << std::fixed << std::setprecision(1) << "  score " << s * 100 << "%";
+			if (s > 0 && s < 1) {
+				double low = std::max(s - margin, 1e-6), high = std::min(s + margin, 1 - 1e-6);
+				std::cout << "  Elo " << elo_difference(s) << " +/- " << (elo_difference(high) - elo_difference(low)) / 2;
+			}
+			else std::cout << "  Elo can't be estimated from all wins or all losses";
+			if (wins + losses > 0) std::cout << "  LOS " << 50 * (1 + std::erf((double(wins) - double(losses)) / std::sqrt(2.0 * double(wins + losses)))) << "%";
+			std::cout << std::endl;
+		}
+		if (settings.sprt == true) {
+			double llr = sprt_llr(wins, draws, losses, settings.elo0, settings.elo1);
+			double lower = std::log(settings.beta / (1 - settings.alpha)), upper = std::log((1 - settings.beta) / settings.alpha);
+			std::cout << std::setprecision(2) << "  SPRT elo0 " << settings.elo0 << " elo1 " << settings.elo1 << "  LLR " << llr << " (" << lower << ", " << upper << ")  "
+				<< (llr >= upper ? "H1 accepted" : llr <= lower ? "H0 accepted" : "no decision yet") << std::endl;
+		}
+
+		std::cout << std::setprecision(2) << "\n  " << match.games_played / seconds << " games/s   " << match.plies / seconds << " moves/s   "
+			<< (match.games_played > 0 ? double(match.plies) / match.games_played : 0) << " plies per game   " << seconds << " s with " << settings.concurrency << " games at once" << std::endl;
+		unsigned long long all_nodes = 0;
+		for (int e = 0; e < 2; e++) {
+			std::vector<float> times; unsigned long long nodes = 0, moves = 0; double search_seconds = 0;
+			for (search_measurements &m : measured) {
+				times.insert(times.end(), m.move_milliseconds[e].begin(), m.move_milliseconds[e].end());
+				nodes += m.nodes[e]; moves += m.moves[e]; search_seconds += m.seconds[e];
+			}
+			all_nodes += nodes;
+			std::cout << "  engine " << char('A' + e) << " (" << settings.engines[e].name << ")  " << moves << " moves  " << (search_seconds > 0 ? nodes / search_seconds / 1e6 : 0)
+				<< " Mnodes/s per game   ms per move: p50 " << std::setprecision(3) << percentile(times, 0.5) << "  p90 " << percentile(times, 0.9)
+				<< "  p99 " << percentile(times, 0.99) << "  max " << percentile(times, 1.0) << std::setprecision(2) << std::endl;
+		}
+		std::cout << "  " << all_nodes / seconds / 1e6 << " Mnodes/s over every game" << std::endl;
+	}
+
+	// Function to name an engine by its settings, for the output and the PGN tags
+	std::string settings_name(const engine_settings &engine, char letter)
+	{
+		std::string name = std::string(1, letter) + ":";
+		if (engine.limits.max_nodes > 0) name += " nodes " + std::to_string(engine.limits.max_nodes);
+		if (engine.limits.max_depth < max_search_depth) name += " depth " + std::to_string(engine.limits.max_depth);
+		if (engine.limits.max_seconds > 0) name += " movetime " + std::to_string(int(engine.limits.max_seconds * 1000));
+		name += engine.eval_file.empty() ? " eval" : " nnue " + engine.eval_file;
+		return name;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	match_settings settings;
+	std::string openings_file;
+	std::string engine_text[2];
+	bool usage_error = false;
+	for (int i = 1; i < argc && usage_error == false; i++) {
+		std::string argument = argv[i];
+		auto number = [&](int offset) { return std::atof(argv[i + offset]); };
+		if (argument == "--games" && i + 1 < argc) settings.games = int(number(1)), i++;
+		else if (argument == "--concurrency" && i + 1 < argc) settings.concurrency = int(number(1)), i++;
+		else if (argument == "--openings" && i + 1 < argc) openings_file = argv[++i];
+		else if (argument == "--random-plies" && i + 1 < argc) settings.random_plies = int(number(1)), i++;
+		else if (argument == "--seed" && i + 1 < argc) settings.seed = std::strtoull(argv[++i], nullptr, 10);
+		else if (argument == "--a" && i + 1 < argc) engine_text[0] = argv[++i];
+		else if (argument == "--b" && i + 1 < argc) engine_text[1] = argv[++i];
+		else if (argument == "--resign" && i + 2 < argc) settings.resign_score = int(number(1)), settings.resign_moves = int(number(2)), i += 2;
+		else if (argument == "--draw" && i + 3 < argc) settings.draw_score = int(number(1)), settings.draw_moves = int(number(2)), settings.draw_from_ply = int(number(3)), i += 3;
+		else if (argument == "--max-plies" && i + 1 < argc) settings.max_plies = int(number(1)), i++;
+		else if (argument == "--sprt" && i + 2 < argc) {
+			settings.sprt = true; settings.elo0 = number(1); settings.elo1 = number(2); i += 2;
+			if (i + 2 < argc && argv[i + 1][0] != '-') { settings.alpha = number(1); settings.beta = number(2); i += 2; }
+		}
+		else if (argument == "--pgn" && i + 1 < argc) settings.pgn_file = argv[++i];
+		else usage_error = true;
+	}
+	for (int e = 0; e < 2 && usage_error == false; e++) {
+		engine_settings &engine = settings.engines[e];
+		engine.limits.max_nodes = 10000;
+		if (engine_text[e].empty() == false) {
+			engine.limits.max_nodes = 0; //limits given in the settings replace the default
+			usage_error = read_engine_settings(engine_text[e], engine) == false;
+		}
+	}
+	if (usage_error || settings.games < 1 || settings.concurrency < 1 || settings.random_plies < 0 || settings.max_plies < 1 || settings.elo1 <= settings.elo0
+		|| settings.alpha <= 0 || settings.alpha >= 0.5 || settings.beta <= 0 || settings.beta >= 0.5) {
+		std::cerr << "Usage: selfplay [--games N] [--concurrency N] [--openings FILE | --random-plies N] [--seed N] [--a SETTINGS] [--b SETTINGS]\n"
+			"                [--resign SCORE MOVES] [--draw SCORE MOVES PLY] [--max-plies N] [--sprt ELO0 ELO1 [ALPHA BETA]] [--pgn FILE]\n"
+			"SETTINGS is a comma separated list of nodes=N, depth=N, movetime=MS, hash=MB and eval=FILE (see selfplay.cpp)" << std::endl;
+		return 1;
+	}
+	settings.games += settings.games % 2;
+	for (int e = 0; e < 2; e++) {
+		engine_settings &engine = settings.engines[e];
+		if (engine.limits.max_nodes == 0 && engine.limits.max_seconds == 0 && engine.limits.max_depth == max_search_depth) {
+			std::cerr << "Engine " << char('A' + e) << " has no limit on its search" << std::endl;
+			return 1;
+		}
+		if (engine.eval_file.empty() == false) {
+			engine.network = std::make_unique<nnue_network>();
+			if (engine.network->load(engine.eval_file.c_str()) == false) { std::cerr << "Can't read the weights file " << engine.eval_file << std::endl; return 1; }
+		}
+		engine.name = settings_name(engine, char('A' + e));
+	}
+	if (openings_file.empty() == false) {
+		std::ifstream file(openings_file);
+		if (!file) { std::cerr << "Can't open " << openings_file << std::endl; return 1; }
+		std::string line;
+		while (std::getline(file, line)) {
+			if (!line.empty() && line.back() == '\r') line.pop_back();
+			if (line.empty() || line[0] == '#') continue;
+			settings.openings.push_back(line);
+		}
+		if (settings.openings.empty()) { std::cerr << "There are no openings in " << openings_file << std::endl; return 1; }
+	}
+
+	match_state match(settings);
+	if (settings.pgn_file.empty() == false) {
+		match.pgn.open(settings.pgn_file);
+		if (!match.pgn) { std::cerr << "Can't write to " << settings.pgn_file << std::endl; return 1; }
+	}
+	std::cout << "Playing " << settings.games << " games, " << settings.concurrency << " at once, from " << (settings.openings.empty() ? std::to_string(settings.random_plies)
+		+ " random moves" : std::to_string(settings.openings.size()) + " openings") << "\n  " << settings.engines[0].name << "\n  " << settings.engines[1].name << std::endl;
+
+	std::vector<search_measurements> measured(std::size_t(settings.concurrency));
+	std::vector<std::thread> workers;
+	for (int i = 0; i < settings.concurrency; i++) workers.emplace_back(run_worker, std::ref(match), std::ref(measured[std::size_t(i)]));
+	for (std::thread &worker : workers) worker.join();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - match.start_time).count();
+	print_results(match, measured, seconds);
+	return 0;
+}
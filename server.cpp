@@ -0,0 +1,502 @@
+// server.cpp implements the functions defined in the server.h header file
+
+#include "server.h"
+#include "piece_attacks.h"
+#include <algorithm>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	// Function to find the top 32 bits of a position key, all a slot keeps of each earlier position (two different positions of one game sharing them is
+	// a one in four billion chance for each earlier position)
+	std::uint32_t key_fragment(std::uint64_t key) { return std::uint32_t(key >> 32); }
+}
+
+// SERVER FUNCTIONS
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// [1]  Function to put a new game into a slot from the position of a board. The slot has no earlier positions, a game set up from a FEN only counts
+//      repetitions from its first position on
+
+void start_slot_game(game_slot &slot, const board &chessboard)
+{
+	slot.position = pack_position(chessboard);
+	slot.number_of_keys = 0;
+	slot.state = std::uint8_t(chessboard.game_status());
+}
+
+// [2]  Function to check and play a move of a slot's game. The slot's position is unpacked onto the work board (each worker has its own), the move must
+//      be pseudo legal and leave the king safe (a promotion must name its piece), and once it is played the position is packed back into the slot. The
+//      key of the position before the move joins the earlier keys, which are cleared by a pawn move or capture since no position before one can come
+//      back. The game's state is then found the same way as board::game_status, counting repetitions in the slot's keys instead of the board's
+
+bool play_slot_move(game_slot &slot, std::string_view move_text, board &work_board, bool &in_check)
+{
+	chess_move m;
+	if (parse_move_text(move_text, m) == false || unpack_position(slot.position, work_board) == false) return false;
+	colour team_colour = work_board.team_to_move();
+	if (work_board.is_pseudo_legal(team_colour, m) == false || work_board.leaves_king_safe(team_colour, m) == false) return false;
+
+	std::uint32_t key_before = key_fragment(work_board.hash_key());
+	work_board.make_move(m);
+	if (work_board.halfmoves() == 0) slot.number_of_keys = 0;
+	else if (slot.number_of_keys < slot_key_history) slot.earlier_keys[slot.number_of_keys++] = key_before;
+
+	std::uint32_t key = key_fragment(work_board.hash_key());
+	int repetitions = 0;
+	for (int back = 2; back <= slot.number_of_keys; back += 2) { //only every second position has the same team to move
+		if (slot.earlier_keys[slot.number_of_keys - back] == key) repetitions++;
+	}
+	colour next_team = work_board.team_to_move();
+	in_check = work_board.checking_pieces(next_team) != 0;
+	if (work_board.has_legal_move(next_team) == false) slot.state = in_check ? game_checkmate : game_stalemate;
+	else if (work_board.halfmoves() >= 100) slot.state = game_fifty_move_draw;
+	else if (repetitions >= 2) slot.state = game_repetition_draw;
+	else slot.state = game_in_play;
+	slot.position = pack_position(work_board);
+	return true;
+}
+
+
+// GAME_POOL CLASS
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// [3]  Parameterised game_pool constructor, every slot is made now and the free list is in reverse so the lowest numbers are handed out first
+
+game_pool::game_pool(std::uint32_t capacity) : slots(capacity), free_slots(capacity) {
+	for (std::uint32_t i = 0; i < capacity; i++) free_slots[i] = capacity - 1 - i;
+}
+
+// [4]  Function to take a free slot for a new game, returns false if every slot is in use
+
+bool game_pool::allocate(std::uint32_t &id) {
+	if (free_slots.empty()) return false;
+	id = free_slots.back(); free_slots.pop_back();
+	game_slot &slot = slots[id];
+	slot.in_use = true; slot.busy = false; slot.end_when_done = false; slot.owner = 0;
+	return true;
+}
+
+// [5]  Function to free the slot of a game that has ended
+
+void game_pool::release(std::uint32_t id) {
+	if (id >= slots.size() || slots[id].in_use == false) return;
+	slots[id].in_use = false;
+	free_slots.push_back(id);
+}
+
+
+#if defined(__linux__)
+namespace {
+	const std::size_t max_line_length = 1024;		// A connection sending a longer line is closed
+	const int max_events = 256;						// The most events taken from epoll at once
+
+	volatile std::sig_atomic_t stop_requested = 0;
+	void request_stop(int) { stop_requested = 1; }
+
+	// A move handed to the workers, and a worker's answer handed back to the event loop
+	struct move_task {
+		std::uint32_t game;
+		int fd;							// The descriptor of the connection to answer
+		std::uint64_t connection;		// The number of the connection, in case it closes and the descriptor is reused before the answer comes back
+		char move[8];
+	};
+	struct move_answer {
+		std::uint32_t game;
+		int fd;
+		std::uint64_t connection;
+		std::string line;
+	};
+
+	// One client connection, indexed by its file descriptor. The number tells a connection apart from a later one that gets the same descriptor
+	struct connection {
+		bool open = false;
+		std::uint64_t number = 0;
+		std::string input;						// Bytes read but not yet a whole line
+		std::string output;						// Answers not yet sent because the socket was full
+		bool waiting_to_write = false;			// Whether epoll is watching for the socket to have room
+		std::vector<std::uint32_t> games;		// The games the connection started, ended when it closes
+	};
+
+	// Everything the event loop and the workers share. The queues are the only thing both sides touch under a lock, the event loop marks a game busy
+	// before handing it over and doesn't look at its position again until the answer comes back
+	struct server_state {
+		game_pool pool;
+		int epoll_fd = -1, listen_fd = -1, wake_fd = -1;
+		int spare_fd = -1;						// A descriptor kept open to be given up when a connection must be turned away for want of one
+		std::vector<connection> connections;
+		std::uint64_t next_connection_number = 1;
+		int open_connections = 0;
+		bool accepting = true;					// Cleared while the listening socket is out of epoll because the process has run out of descriptors
+		unsigned long long moves_checked = 0;
+
+		std::mutex task_lock;
+		std::condition_variable task_ready;
+		std::deque<move_task> tasks;
+		bool shutting_down = false;
+		std::mutex answer_lock;
+		std::vector<move_answer> answers;
+
+		explicit server_state(std::uint32_t capacity) : pool(capacity) {}
+	};
+
+	const char *state_text(std::uint8_t state, bool in_check)
+	{
+		switch (state) {
+		case game_checkmate:		return "checkmate";
+		case game_stalemate:		return "stalemate";
+		case game_fifty_move_draw:	return "fifty_move_draw";
+		case game_repetition_draw:	return "repetition_draw";
+		default:					return in_check ? "check" : "in_play";
+		}
+	}
+
+	// Function run by each worker thread: take a move, check and play it on the worker's own board, hand the answer back and wake the event loop
+	void run_worker(server_state &server)
+	{
+		board work_board;
+		for (;;) {
+			move_task task;
+			{
+				std::unique_lock<std::mutex> lock(server.task_lock);
+				server.task_ready.wait(lock, [&server]() { return server.shutting_down || !server.tasks.empty(); });
+				if (server.tasks.empty()) return;
+				task = server.tasks.front(); server.tasks.pop_front();
+			}
+			game_slot &slot = *server.pool.find(task.game); //the slot stays in use while it is busy
+			bool in_check = false;
+			std::string id = std::to_string(task.game);
+			move_answer answer{ task.game, task.fd, task.connection, std::string() };
+			if (play_slot_move(slot, task.move, work_board, in_check) == true) answer.line = "ok " + id + " " + task.move + " " + state_text(slot.state, in_check);
+			else answer.line = "illegal " + id + " " + task.move;
+			{
+				std::lock_guard<std::mutex> lock(server.answer_lock);
+				server.answers.push_back(std::move(answer));
+			}
+			std::uint64_t one = 1;
+			if (write(server.wake_fd, &one, sizeof(one)) < 0) {} //the event loop only needs waking once however many answers are waiting
+		}
+	}
+
+	// Function to send as much of a connection's waiting output as the socket takes, watching for room to send the rest
+	void flush_connection(server_state &server, int fd)
+	{
+		connection &c = server.connections[fd];
+		std::size_t sent = 0;
+		while (sent < c.output.size()) {
+			ssize_t n = send(fd, c.output.data() + sent, c.output.size() - sent, MSG_NOSIGNAL);
+			if (n > 0) { sent += std::size_t(n); continue; }
+			if (n < 0 && errno == EINTR) continue;
+			break; //the socket is full (or broken, which the next read finds)
+		}
+		c.output.erase(0, sent);
+		bool waiting = !c.output.empty();
+		if (waiting != c.waiting_to_write) {
+			epoll_event event{}; event.events = std::uint32_t(EPOLLIN) | (waiting ? std::uint32_t(EPOLLOUT) : 0u); event.data.fd = fd;
+			epoll_ctl(server.epoll_fd, EPOLL_CTL_MOD, fd, &event);
+			c.waiting_to_write = waiting;
+		}
+	}
+
+	// Function to end a game, straight away if no move of it is being checked or once the move is done
+	void end_game(server_state &server, std::uint32_t id)
+	{
+		game_slot *slot = server.pool.find(id);
+		if (slot == nullptr) return;
+		if (slot->busy == true) slot->end_when_done = true;
+		else server.pool.release(id);
+	}
+
+	// Function to close a connection and end the games it started (a game started by it that has since ended and been reused by another connection has a
+	// different owner and is left alone). The descriptor it frees lets the listening socket back into epoll if accepting stopped for want of one
+	void close_connection(server_state &server, int fd)
+	{
+		connection &c = server.connections[fd];
+		for (std::uint32_t id : c.games) {
+			game_slot *slot = server.pool.find(id);
+			if (slot != nullptr && slot->owner == c.number) end_game(server, id);
+		}
+		epoll_ctl(server.epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+		close(fd);
+		c = connection();
+		server.open_connections--;
+		if (server.accepting == false) {
+			epoll_event event{}; event.events = EPOLLIN; event.data.fd = server.listen_fd;
+			epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.listen_fd, &event);
+			server.accepting = true;
+		}
+	}
+
+	// Function to read a game number from a command, returns false if it isn't a number
+	bool read_id(const std::string &word, std::uint32_t &id)
+	{
+		if (word.empty() || word.size() > 9 || word.find_first_not_of("0123456789") != std::string::npos) return false;
+		id = std::uint32_t(std::strtoul(word.c_str(), nullptr, 10));
+		return true;
+	}
+
+	// Function to carry out one command line of a connection, see server.h. Every answer but a move's is added to the connection's output straight away.
+	// Returns false if the connection should be closed
+	bool run_command(server_state &server, int fd, const std::string &line)
+	{
+		connection &c = server.connections[fd];
+		std::size_t space = line.find(' ');
+		std::string command = line.substr(0, space), rest = space == std::string::npos ? std::string() : line.substr(space + 1);
+		std::size_t second_space = rest.find(' ');
+		std::string first_word = rest.substr(0, second_space), second_word = second_space == std::string::npos ? std::string() : rest.substr(second_space + 1);
+		std::uint32_t id = 0;
+		game_slot *slot = nullptr;
+		if (command == "move" || command == "fen" || command == "end") {
+			if (read_id(first_word, id) == false || (slot = server.pool.find(id)) == nullptr) { c.output += "error " + first_word + " unknown\n"; return true; }
+		}
+
+		if (command == "new") {
+			board chessboard;
+			if (rest.empty() == false && chessboard.from_fen(rest) == false) { c.output += "error fen\n"; return true; }
+			if (server.pool.allocate(id) == false) { c.output += "error full\n"; return true; }
+			slot = server.pool.find(id);
+			start_slot_game(*slot, chessboard);
+			slot->owner = c.number;
+			c.games.push_back(id);
+			c.output += "game " + std::to_string(id) + "\n";
+		}
+		else if (command == "move") {
+			if (slot->busy == true) { c.output += "error " + first_word + " busy\n"; return true; }
+			if (slot->state != game_in_play) { c.output += "error " + first_word + " over\n"; return true; }
+			if (second_word.empty() || second_word.size() > 5) { c.output += "illegal " + first_word + " " + second_word + "\n"; return true; }
+			move_task task{ id, fd, c.number, {} };
+			std::memcpy(task.move, second_word.c_str(), second_word.size() + 1);
+			slot->busy = true;
+			{
+				std::lock_guard<std::mutex> lock(server.task_lock);
+				server.tasks.push_back(task);
+			}
+			server.task_ready.notify_one();
+		}
+		else if (command == "fen") {
+			if (slot->busy == true) { c.output += "error " + first_word + " busy\n"; return true; }
+			board chessboard;
+			char fen[max_fen_length];
+			unpack_position(slot->position, chessboard);
+			chessboard.to_fen(fen);
+			c.output += "fen " + first_word + " " + fen + "\n";
+		}
+		else if (command == "end") {
+			if (slot->owner == c.number) c.games.erase(std::remove(c.games.begin(), c.games.end(), id), c.games.end());
+			end_game(server, id);
+			c.output += "ended " + first_word + "\n";
+		}
+		else if (command == "stats") {
+			c.output += "stats games " + std::to_string(server.pool.games()) + " connections " + std::to_string(server.open_connections)
+				+ " moves " + std::to_string(server.moves_checked) + "\n";
+		}
+		else if (command == "quit") return false;
+		else c.output += "error command\n";
+		return true;
+	}
+
+	// Function to read everything waiting on a connection and carry out each whole line. A connection that closes, fails or sends a line that is too long
+	// is closed
+	void read_connection(server_state &server, int fd)
+	{
+		char buffer[4096];
+		for (;;) {
+			ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+			if (n > 0) { server.connections[fd].input.append(buffer, std::size_t(n)); continue; }
+			if (n < 0 && errno == EINTR) continue;
+			if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+			close_connection(server, fd); //the client closed the connection or it failed
+			return;
+		}
+
+		connection &c = server.connections[fd];
+		std::size_t start = 0, end;
+		while ((end = c.input.find('\n', start)) != std::string::npos) {
+			std::string line = c.input.substr(start, end - start);
+			if (!line.empty() && line.back() == '\r') line.pop_back();
+			start = end + 1;
+			if (line.empty()) continue;
+			if (run_command(server, fd, line) == false) { flush_connection(server, fd); close_connection(server, fd); return; }
+		}
+		c.input.erase(0, start);
+		if (c.input.size() > max_line_length) { close_connection(server, fd); return; }
+		flush_connection(server, fd);
+	}
+
+	// Function to accept every waiting connection. If the process runs out of descriptors the waiting connections can't be accepted, and since the
+	// listening socket is level triggered epoll would report it again straight away and the loop would spin, so it is taken out of epoll until a
+	// connection closes (close_connection puts it back), the clients waiting in the listen backlog meanwhile. With no connections open none will close,
+	// so instead the spare descriptor is given up to accept the waiting connection and close it at once, turning the client away
+	void accept_connections(server_state &server)
+	{
+		for (;;) {
+			int fd = accept4(server.listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if (fd < 0) {
+				if (errno == EINTR || errno == ECONNABORTED) continue;
+				if (errno != EMFILE && errno != ENFILE && errno != ENOBUFS && errno != ENOMEM) return; //no more waiting (EAGAIN)
+				if (server.open_connections > 0) {
+					epoll_ctl(server.epoll_fd, EPOLL_CTL_DEL, server.listen_fd, nullptr);
+					server.accepting = false;
+					std::cerr << "Out of descriptors with " << server.open_connections << " connections, accepting again once one closes" << std::endl;
+					return;
+				}
+				if (server.spare_fd < 0) return;
+				close(server.spare_fd);
+				fd = accept(server.listen_fd, nullptr, nullptr);
+				if (fd >= 0) close(fd);
+				server.spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+				if (fd < 0) return;
+				continue;
+			}
+			if (std::size_t(fd) >= server.connections.size()) server.connections.resize(std::size_t(fd) + 1);
+			connection &c = server.connections[fd];
+			c = connection();
+			c.open = true; c.number = server.next_connection_number++;
+			epoll_event event{}; event.events = EPOLLIN; event.data.fd = fd;
+			epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, fd, &event);
+			server.open_connections++;
+		}
+	}
+
+	// Function to send the workers' answers to the connections that asked, freeing the games that were ended while their moves were checked
+	void deliver_answers(server_state &server)
+	{
+		std::uint64_t count;
+		if (read(server.wake_fd, &count, sizeof(count)) < 0) {}
+		std::vector<move_answer> answers;
+		{
+			std::lock_guard<std::mutex> lock(server.answer_lock);
+			answers.swap(server.answers);
+		}
+		std::vector<int> to_flush;
+		for (move_answer &answer : answers) {
+			server.moves_checked++;
+			game_slot *slot = server.pool.find(answer.game);
+			if (slot != nullptr) {
+				slot->busy = false;
+				if (slot->end_when_done == true) server.pool.release(answer.game);
+			}
+			connection &c = server.connections[answer.fd]; //the answer goes to the connection if it is still open
+			if (c.open == false || c.number != answer.connection) continue;
+			if (c.output.empty()) to_flush.push_back(answer.fd);
+			c.output += answer.line; c.output += '\n';
+		}
+		for (int fd : to_flush) if (server.connections[fd].open == true) flush_connection(server, fd);
+	}
+
+	// Function to open the listening socket, a Unix socket if a path is given and otherwise a TCP port on the local machine only
+	int open_listener(const char *unix_path, int port)
+	{
+		int fd;
+		if (unix_path != nullptr) {
+			sockaddr_un address{}; address.sun_family = AF_UNIX;
+			if (std::strlen(unix_path) >= sizeof(address.sun_path)) return -1;
+			std::strcpy(address.sun_path, unix_path);
+			unlink(unix_path); //a socket file left by an earlier server
+			fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+			if (fd < 0 || bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) return -1;
+		}
+		else {
+			sockaddr_in address{}; address.sin_family = AF_INET; address.sin_port = htons(std::uint16_t(port)); address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+			int yes = 1;
+			if (fd < 0 || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) < 0) return -1;
+			if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) return -1;
+		}
+		if (listen(fd, SOMAXCONN) < 0) return -1;
+		return fd;
+	}
+}
+
+// [9]  Function to run the server from the command line arguments that follow "--server": "--port N" (7777 by default) or "--unix PATH" to listen on,
+//      "--threads N" workers (every core by default) and "--games N" slots (16384 by default). The server runs until it is interrupted (SIGINT or SIGTERM)
+
+int server_main(int argc, char *argv[])
+{
+	const char *unix_path = nullptr;
+	int port = 7777;
+	int number_of_threads = int(std::thread::hardware_concurrency());
+	long long capacity = 16384;
+	for (int i = 0; i < argc; i++) {
+		std::string argument = argv[i];
+		if (argument == "--port" && i + 1 < argc) port = std::atoi(argv[++i]);
+		else if (argument == "--unix" && i + 1 < argc) unix_path = argv[++i];
+		else if (argument == "--threads" && i + 1 < argc) number_of_threads = std::atoi(argv[++i]);
+		else if (argument == "--games" && i + 1 < argc) capacity = std::atoll(argv[++i]);
+		else { std::cerr << "Usage: chess --server [--port N | --unix PATH] [--threads N] [--games N]" << std::endl; return 1; }
+	}
+	if (number_of_threads < 1) number_of_threads = 1;
+	if (capacity < 1 || capacity > 16777216 || port < 1 || port > 65535) { std::cerr << "The port or number of games is out of range" << std::endl; return 1; }
+
+	server_state server{ std::uint32_t(capacity) };
+	server.listen_fd = open_listener(unix_path, port);
+	if (server.listen_fd < 0) { std::cerr << "Can't listen on " << (unix_path != nullptr ? unix_path : "port " + std::to_string(port)) << ": " << std::strerror(errno) << std::endl; return 1; }
+	server.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	server.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	server.spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+	epoll_event event{}; event.events = EPOLLIN;
+	event.data.fd = server.listen_fd; epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.listen_fd, &event);
+	event.data.fd = server.wake_fd; epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.wake_fd, &event);
+	std::signal(SIGINT, request_stop); std::signal(SIGTERM, request_stop);
+
+	std::vector<std::thread> workers;
+	for (int i = 0; i < number_of_threads; i++) workers.emplace_back(run_worker, std::ref(server));
+	std::cerr << "Serving up to " << capacity << " games (" << sizeof(game_slot) << " bytes each) on " << (unix_path != nullptr ? unix_path : "port " + std::to_string(port))
+		<< " with " << number_of_threads << " worker threads" << std::endl;
+
+	epoll_event events[max_events];
+	while (stop_requested == 0) {
+		int n = epoll_wait(server.epoll_fd, events, max_events, -1);
+		if (n < 0) { if (errno == EINTR) continue; break; }
+		for (int i = 0; i < n; i++) {
+			int fd = events[i].data.fd;
+			if (fd == server.listen_fd) accept_connections(server);
+			else if (fd == server.wake_fd) deliver_answers(server);
+			else if (std::size_t(fd) < server.connections.size() && server.connections[fd].open == true) {
+				if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) read_connection(server, fd);
+				if ((events[i].events & EPOLLOUT) && server.connections[fd].open == true) flush_connection(server, fd);
+			}
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(server.task_lock);
+		server.shutting_down = true;
+	}
+	server.task_ready.notify_all();
+	for (std::thread &worker : workers) worker.join();
+	for (std::size_t fd = 0; fd < server.connections.size(); fd++) if (server.connections[fd].open == true) close_connection(server, int(fd));
+	close(server.listen_fd); close(server.wake_fd); close(server.epoll_fd);
+	if (server.spare_fd >= 0) close(server.spare_fd);
+	if (unix_path != nullptr) unlink(unix_path);
+	std::cerr << "Stopped after checking " << server.moves_checked << " moves" << std::endl;
+	return 0;
+}
+
+#else
+
+// [9]  Function to run the server, which needs epoll so it is only built on Linux
+
+int server_main(int, char *[])
+{
+	std::cerr << "The server mode needs Linux (epoll)" << std::endl;
+	return 1;
+}
+
+#endif
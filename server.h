@@ -0,0 +1,66 @@
+// server.h declares the server mode of the chess executable, which hosts many games at once for clients connecting over a local TCP port or Unix socket,
+// instead of one process playing one game on the console. A single thread runs an event loop (epoll) over every connection, reading commands and writing
+// answers without ever blocking, so thousands of games cost no threads of their own. Each game lives in a game_slot of a game_pool made when the server
+// starts: the position packed into 32 bytes (see storage.h) and the part of the key history needed to find repetitions, a few hundred bytes with no heap
+// memory, instead of a whole board. The moves are checked by a pool of worker threads: the event loop hands a move to the workers, one of them unpacks
+// the slot onto its own board, checks the move with the rules engine, plays it and packs the position back, and the event loop is woken to send the answer.
+//
+// The protocol is one command per line, answered by one line (a move is answered when a worker has checked it, so answers can come back in a different
+// order from the commands, each answer names its game):
+//
+//	new [FEN]				starts a game from the start position or a FEN				->	game <id>		or  error full / error fen
+//	move <id> <move>		plays a move in coordinate notation (e.g. "e2e4")			->	ok <id> <move> <state>  or  illegal <id> <move>
+//	fen <id>				the position of a game										->	fen <id> <FEN>
+//	end <id>				ends a game and frees its slot								->	ended <id>
+//	stats					the number of games, connections and moves checked			->	stats games <n> connections <n> moves <n>
+//	quit					closes the connection
+//
+// The state after a move is in_play, check, checkmate, stalemate, fifty_move_draw or repetition_draw, and a game that has ended takes no more moves
+// ("error <id> over"). While a game's move is being checked the game takes no other command ("error <id> busy"), so its moves are always played in order.
+// Any connection can play any game by its id. The games a connection started are ended when it closes, and ids are reused once a game has ended.
+// The server runs on Linux, where epoll is available
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "board_and_players.h"
+#include "storage.h"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+const int slot_key_history = 100;		// A game_slot remembers the keys of the positions since the last pawn move or capture, the fifty move rule ends the
+										// game before there are more
+
+																																// GAME_SLOT STRUCT
+struct game_slot {																												//--------------------------------------------------------------------------------------------------------
+	packed_position position;							// The position of the game
+	std::uint32_t earlier_keys[slot_key_history];		// The top 32 bits of the keys of the positions since the last pawn move or capture, oldest first
+	std::uint8_t number_of_keys;
+	std::uint8_t state;									// The game_state after the last move
+	bool in_use;										// Whether the slot holds a game
+	bool busy;											// Set by the event loop while a worker checks a move of the game
+	bool end_when_done;									// Set when the game is ended while a move is being checked, the slot is freed once the move is done
+	std::uint64_t owner;								// The number of the connection that started the game
+};
+
+void start_slot_game(game_slot &slot, const board &chessboard);																	// [1]  Function to put a new game into a slot from the position of a board
+bool play_slot_move(game_slot &slot, std::string_view move_text, board &work_board, bool &in_check);							// [2]  Function to check and play a move of a slot's game on a board, returns false if it isn't legal
+
+																																// GAME_POOL CLASS
+class game_pool {																												//--------------------------------------------------------------------------------------------------------
+private:
+	std::vector<game_slot> slots;					// Every slot, made when the pool is made so starting a game never allocates
+	std::vector<std::uint32_t> free_slots;			// The numbers of the slots without a game
+public:
+	explicit game_pool(std::uint32_t capacity);																					// [3]  Parameterised game_pool constructor, makes room for capacity games
+	bool allocate(std::uint32_t &id);																							// [4]  Function to take a free slot for a new game, returns false if every slot is in use
+	void release(std::uint32_t id);																								// [5]  Function to free the slot of a game that has ended
+	game_slot *find(std::uint32_t id) { return id < slots.size() && slots[id].in_use ? &slots[id] : nullptr; }					// [6]  Function to find the slot of a game, or nullptr if there is no such game
+	std::uint32_t capacity() const { return std::uint32_t(slots.size()); }														// [7]  Function to retrieve the number of slots
+	std::uint32_t games() const { return std::uint32_t(slots.size() - free_slots.size()); }										// [8]  Function to retrieve the number of games being played
+};
+
+int server_main(int argc, char *argv[]);																						// [9]  Function to run the server from the command line arguments that follow "--server"
+
+#endif
@@ -0,0 +1,358 @@
+// storage.cpp implements the functions defined in the storage.h header file
+
+#include "storage.h"
+#include "zobrist.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+	const char file_magic[8] = { 'C', 'H', 'E', 'S', 'S', 'R', 'E', 'C' };		// The first 8 bytes of a file of records
+	const char footer_magic[8] = { 'C', 'H', 'E', 'S', 'S', 'I', 'D', 'X' };	// The last 8 bytes of a finished file
+	const std::uint32_t format_version = 1;
+	const std::size_t position_bytes = 32;		// The size of a stored position
+	const std::size_t footer_bytes = 32;		// Index offset, number of blocks, number of records and the magic
+
+	// Functions to append a little endian number to a buffer and to read one back
+	void put_number(std::vector<std::uint8_t> &out, std::uint64_t value, int bytes)
+	{
+		for (int i = 0; i < bytes; i++) out.push_back(std::uint8_t(value >> (8 * i)));
+	}
+
+	std::uint64_t get_number(const std::uint8_t *in, int bytes)
+	{
+		std::uint64_t value = 0;
+		for (int i = 0; i < bytes; i++) value |= std::uint64_t(in[i]) << (8 * i);
+		return value;
+	}
+
+	void put_position(std::vector<std::uint8_t> &out, const packed_position &packed)
+	{
+		put_number(out, packed.occupancy, 8);
+		out.insert(out.end(), packed.pieces, packed.pieces + 16);
+		out.push_back(packed.flags);
+		out.push_back(std::uint8_t(packed.en_passant_column));
+		put_number(out, packed.halfmove_clock, 2);
+		put_number(out, packed.fullmove_number, 2);
+		put_number(out, std::uint16_t(packed.score), 2);
+	}
+
+	void get_position(const std::uint8_t *in, packed_position &packed)
+	{
+		packed.occupancy = get_number(in, 8);
+		std::copy(in + 8, in + 24, packed.pieces);
+		packed.flags = in[24];
+		packed.en_passant_column = std::int8_t(in[25]);
+		packed.halfmove_clock = std::uint16_t(get_number(in + 26, 2));
+		packed.fullmove_number = std::uint16_t(get_number(in + 28, 2));
+		packed.score = std::int16_t(std::uint16_t(get_number(in + 30, 2)));
+	}
+}
+
+// STORAGE FUNCTIONS
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// [1]  Function to pack the position of a board into 32 bytes, the piece codes of the occupied squares are taken in bit index order so the occupancy
+//      bitboard says which square each code belongs to
+
+packed_position pack_position(const board &chessboard, int score)
+{
+	const position &p = chessboard.get_position();
+	packed_position packed{};
+	packed.occupancy = p.occupancy();
+	bitboard occupied = packed.occupancy;
+	for (int n = 0; occupied; n++) {
+		int index = pop_lowest_square(occupied);
+		packed.pieces[n >> 1] |= std::uint8_t(p.piece_codes[index] << (4 * (n & 1)));
+	}
+	packed.flags = std::uint8_t((chessboard.team_to_move() == black ? 1 : 0) | (chessboard.castling() << 1));
+	packed.en_passant_column = chessboard.en_passant();
+	packed.halfmove_clock = std::uint16_t(chessboard.halfmoves());
+	packed.fullmove_number = std::uint16_t(chessboard.move_number());
+	packed.score = std::int16_t(std::max(-32767, std::min(32767, score)));
+	return packed;
+}
+
+// [2]  Function to unpack the pieces of a packed position into bitboards, without a board. Returns false if an occupied square has a code that isn't a
+//      piece (0, 7, 8 or 15, whose piece_index would be off either end of a team's piece sets) or there are more than 32 pieces
+
+bool unpack_position(const packed_position &packed, position &p)
+{
+	p.clear();
+	if (count_squares(packed.occupancy) > 32) return false;
+	bitboard occupied = packed.occupancy;
+	for (int n = 0; occupied; n++) {
+		int index = pop_lowest_square(occupied);
+		piece_code code = piece_code((packed.pieces[n >> 1] >> (4 * (n & 1))) & 15);
+		if ((code & 7) == 0 || (code & 7) == 7 || code > 14) return false;
+		p.add_piece(code_colour(code), code_type(code), index);
+	}
+	return true;
+}
+
+// [3]  Function to set up a board from a packed position, returns false if it isn't a possible position (a piece code that isn't a piece, more than
+//      32 pieces, a team without a king or an en passant column off the board)
+
+bool unpack_position(const packed_position &packed, board &chessboard)
+{
+	position p;
+	if (unpack_position(packed, p) == false) return false;
+	for (int team = 0; team < 2; team++) {
+		if (p.piece_sets[team][king_index] == 0) return false;
+	}
+	if (packed.en_passant_column < no_en_passant || packed.en_passant_column > 7) return false;
+	chessboard.set_position(p, (packed.flags & 1) ? black : white, std::uint8_t((packed.flags >> 1) & 15), packed.en_passant_column,
+		packed.halfmove_clock, packed.fullmove_number);
+	return true;
+}
+
+
+// RECORD_WRITER CLASS
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// [4]  Function to write the block being filled to the file, with its number of records and size in front, and add it to the index
+
+void record_writer::write_block()
+{
+	if (records_in_block == 0) return;
+	index.push_back(std::uint64_t(file.tellp()));
+	index.push_back(number_of_records - std::uint64_t(records_in_block));
+	std::vector<std::uint8_t> header;
+	put_number(header, std::uint32_t(records_in_block), 4);
+	put_number(header, std::uint32_t(block.size()), 4);
+	file.write(reinterpret_cast<const char *>(header.data()), std::streamsize(header.size()));
+	file.write(reinterpret_cast<const char *>(block.data()), std::streamsize(block.size()));
+	block.clear(); records_in_block = 0;
+}
+
+// [5]  Unparameterised record_writer constructor
+
+record_writer::record_writer() : type{ position_records }, records_in_block{ 0 }, number_of_records{ 0 } {}
+
+// [6]  Record_writer destructor, finishes the file if it is still open
+
+record_writer::~record_writer() { close(); }
+
+// [7]  Function to start a new file of one type of record, returns false if it can't be created
+
+bool record_writer::open(const char *file_name, record_type type_of_records)
+{
+	close();
+	file.open(file_name, std::ios::binary | std::ios::trunc);
+	if (!file) return false;
+	type = type_of_records; records_in_block = 0; number_of_records = 0;
+	block.clear(); index.clear();
+	std::vector<std::uint8_t> header(file_magic, file_magic + 8);
+	put_number(header, format_version, 4);
+	put_number(header, std::uint32_t(type), 4);
+	file.write(reinterpret_cast<const char *>(header.data()), std::streamsize(header.size()));
+	return bool(file);
+}
+
+// [8]  Function to add a position to a file of positions
+
+void record_writer::write_position(const packed_position &packed)
+{
+	put_position(block, packed);
+	number_of_records++;
+	if (++records_in_block == records_per_block) write_block();
+}
+
+// [9]  Function to add a game to a file of games: its outcome, whether it has a start position, its number of moves, the start position if it has one and
+//      then its moves
+
+void record_writer::write_game(const stored_game &game)
+{
+	int number_of_moves = std::min(game.number_of_moves, max_stored_plies);
+	block.push_back(game.outcome);
+	block.push_back(game.has_start_position ? 1 : 0);
+	put_number(block, std::uint16_t(number_of_moves), 2);
+	if (game.has_start_position) put_position(block, game.start_position);
+	for (int i = 0; i < number_of_moves; i++) put_number(block, game.moves[i], 2);
+	number_of_records++;
+	if (++records_in_block == records_per_block) write_block();
+}
+
+// [10] Function to write the last block, the index and the footer, returns false if anything couldn't be written
+
+bool record_writer::close()
+{
+	if (!file.is_open()) return true;
+	write_block();
+	std::vector<std::uint8_t> tail;
+	std::uint64_t index_offset = std::uint64_t(file.tellp());
+	for (std::uint64_t value : index) put_number(tail, value, 8);
+	put_number(tail, index_offset, 8);
+	put_number(tail, index.size() / 2, 8);
+	put_number(tail, number_of_records, 8);
+	tail.insert(tail.end(), footer_magic, footer_magic + 8);
+	file.write(reinterpret_cast<const char *>(tail.data()), std::streamsize(tail.size()));
+	bool written = bool(file);
+	file.close();
+	return written;
+}
+
+
+// RECORD_READER CLASS
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// [12] Function to read a block of records from the file
+
+bool record_reader::load_block(std::size_t block_number)
+{
+	if (block_number >= blocks()) return false;
+	std::uint64_t start = index[2 * block_number];
+	if (start < 16 || start > index_offset - 8) return false; //a damaged index, the block must lie between the header and the index
+	std::uint8_t header[8];
+	file.clear();
+	file.seekg(std::streamoff(start));
+	if (!file.read(reinterpret_cast<char *>(header), 8)) return false;
+	records_left_in_block = int(get_number(header, 4));
+	std::uint64_t size = get_number(header + 4, 4);
+	if (size > index_offset - 8 - start) return false;
+	block.resize(std::size_t(size));
+	if (!file.read(reinterpret_cast<char *>(block.data()), std::streamsize(block.size()))) return false;
+	block_offset = 0;
+	next_block = block_number + 1;
+	return true;
+}
+
+// [13] Unparameterised record_reader constructor
+
+record_reader::record_reader() : type{ position_records }, number_of_records{ 0 }, index_offset{ 0 }, block_offset{ 0 }, records_left_in_block{ 0 }, next_block{ 0 } {}
+
+// [14] Function to open a file and read its index from the footer at the end, returns false if it isn't a finished file of records
+
+bool record_reader::open(const char *file_name)
+{
+	file.close(); file.clear();
+	index.clear(); number_of_records = 0; index_offset = 0; records_left_in_block = 0; next_block = 0;
+	file.open(file_name, std::ios::binary);
+	if (!file) return false;
+
+	std::uint8_t header[16];
+	if (!file.read(reinterpret_cast<char *>(header), 16) || std::equal(file_magic, file_magic + 8, header) == false) return false;
+	if (get_number(header + 8, 4) != format_version) return false;
+	type = record_type(get_number(header + 12, 4));
+
+	std::uint8_t footer[footer_bytes];
+	file.seekg(0, std::ios::end);
+	std::uint64_t file_size = std::uint64_t(file.tellg());
+	if (file_size < 16 + footer_bytes) return false;
+	file.seekg(-std::streamoff(footer_bytes), std::ios::end);
+	if (!file.read(reinterpret_cast<char *>(footer), footer_bytes) || std::equal(footer_magic, footer_magic + 8, footer + 24) == false) return false;
+	index_offset = get_number(footer, 8);
+	std::uint64_t number_of_blocks = get_number(footer + 8, 8);
+	number_of_records = get_number(footer + 16, 8);
+	//the index must lie between the header and the footer, so a damaged footer can't ask for more memory than the file holds
+	if (index_offset < 16 || index_offset > file_size - footer_bytes || number_of_blocks > (file_size - footer_bytes - index_offset) / 16) return false;
+
+	std::vector<std::uint8_t> index_bytes(std::size_t(number_of_blocks * 16));
+	file.seekg(std::streamoff(index_offset));
+	if (!file.read(reinterpret_cast<char *>(index_bytes.data()), std::streamsize(index_bytes.size()))) return false;
+	for (std::size_t i = 0; i < index_bytes.size(); i += 8) index.push_back(get_number(&index_bytes[i], 8));
+	return true;
+}
+
+// [18] Function to move to a record so that it is the next one read. The block holding it is found in the index with a binary search, then positions are
+//      jumped straight to (they are all the same size) and games before it in the block are skipped over
+
+bool record_reader::seek(std::uint64_t record_number)
+{
+	if (record_number >= number_of_records) return false;
+	std::size_t low = 0, high = blocks(); //the block is the last one whose first record is at or before record_number
+	while (high - low > 1) {
+		std::size_t middle = (low + high) / 2;
+		if (index[2 * middle + 1] <= record_number) low = middle;
+		else high = middle;
+	}
+	if (load_block(low) == false) return false;
+	std::uint64_t skip = record_number - index[2 * low + 1];
+	if (type == position_records) block_offset = std::size_t(skip) * position_bytes;
+	else {
+		for (std::uint64_t i = 0; i < skip; i++) { //each game's size is checked against the block the same way read_game checks it
+			if (block_offset + 4 > block.size()) return false;
+			std::size_t moves = std::size_t(get_number(&block[block_offset + 2], 2));
+			std::size_t size = 4 + (block[block_offset + 1] ? position_bytes : 0) + 2 * moves;
+			if (block_offset + size > block.size()) return false;
+			block_offset += size;
+		}
+	}
+	records_left_in_block -= int(skip);
+	return true;
+}
+
+// [19] Function to read the next position of a file of positions, returns false at the end of the file
+
+bool record_reader::read_position(packed_position &packed)
+{
+	if (type != position_records) return false;
+	if (records_left_in_block == 0 && load_block(next_block) == false) return false;
+	if (block_offset + position_bytes > block.size()) return false;
+	get_position(&block[block_offset], packed);
+	block_offset += position_bytes; records_left_in_block--;
+	return true;
+}
+
+// [20] Function to read the next game of a file of games, returns false at the end of the file
+
+bool record_reader::read_game(stored_game &game)
+{
+	if (type != game_records) return false;
+	if (records_left_in_block == 0 && load_block(next_block) == false) return false;
+	if (block_offset + 4 > block.size()) return false;
+	const std::uint8_t *in = &block[block_offset];
+	game.outcome = in[0];
+	game.has_start_position = in[1] != 0;
+	game.number_of_moves = int(get_number(in + 2, 2));
+	std::size_t size = 4 + (game.has_start_position ? position_bytes : 0) + 2 * std::size_t(game.number_of_moves);
+	if (block_offset + size > block.size() || game.number_of_moves > max_stored_plies) return false;
+	in += 4;
+	if (game.has_start_position) { get_position(in, game.start_position); in += position_bytes; }
+	for (int i = 0; i < game.number_of_moves; i++) game.moves[i] = std::uint16_t(get_number(in + 2 * i, 2));
+	block_offset += size; records_left_in_block--;
+	return true;
+}
+
+
+// STORAGE MODE
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// [21] Function to print the records of a file from the command line arguments that follow "--read": the file, then optionally the number (from 0) of the
+//      first record to print and how many to print (all of the rest by default). Positions are printed in FEN with their score and games as their result,
+//      their start position if it isn't the usual one and their moves in coordinate notation
+
+int storage_main(int argc, char *argv[])
+{
+	if (argc < 1) { std::cerr << "Usage: chess --read <file> [first record [number of records]]" << std::endl; return 1; }
+	record_reader reader;
+	if (reader.open(argv[0]) == false) { std::cerr << "Can't read " << argv[0] << std::endl; return 1; }
+	std::uint64_t first = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 0;
+	std::uint64_t count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : reader.records();
+
+	std::ios::sync_with_stdio(false);
+	std::cerr << reader.records() << (reader.records_type() == position_records ? " positions" : " games") << " in " << reader.blocks() << " blocks\n";
+	if (count == 0 || first >= reader.records()) return 0;
+	if (reader.seek(first) == false) { std::cerr << "Can't read record " << first << std::endl; return 1; }
+
+	static const char *results[4] = { "*", "1-0", "0-1", "1/2-1/2" }; //indexed by game_outcome
+	board chessboard;
+	char fen[max_fen_length];
+	packed_position packed;
+	stored_game game;
+	for (std::uint64_t record = first; record < first + count; record++) {
+		if (reader.records_type() == position_records) {
+			if (reader.read_position(packed) == false) break;
+			if (unpack_position(packed, chessboard) == false) { std::cout << record << " bad position\n"; continue; }
+			chessboard.to_fen(fen);
+			std::cout << record << ' ' << fen << " score " << packed.score << '\n';
+		}
+		else {
+			if (reader.read_game(game) == false) break;
+			std::cout << record << ' ' << results[game.outcome & 3];
+			if (game.has_start_position && unpack_position(game.start_position, chessboard) == true) {
+				chessboard.to_fen(fen);
+				std::cout << " [" << fen << ']';
+			}
+			for (int i = 0; i < game.number_of_moves; i++) std::cout << ' ' << move_text(unpack_move(game.moves[i]));
+			std::cout << '\n';
+		}
+	}
+	return 0;
+}
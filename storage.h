@@ -0,0 +1,97 @@
+// storage.h declares a compact binary format for storing positions and games. A move is stored in 16 bits (6 bits each for the start and end squares
+// and 4 bits for a promotion piece) and a position in a fixed 32 bytes: the occupied squares as a bitboard, then one 4 bit piece code for each occupied
+// square in order (a position has at most 32 pieces, so 16 bytes), then the team to move, castling rights, en passant column, halfmove clock, move number
+// and a score. A game is stored as its result, its start position if it isn't the usual one, and its moves.
+//
+// A file is a header, then blocks of records, then an index of the blocks and a footer. Each block holds up to records_per_block records and the index
+// gives the file offset and first record number of every block, so any record can be found by reading the footer, the index and one block. Records are
+// written and read a block at a time, so however many records a file holds the writer and reader only ever keep one block in memory, and reading a
+// record gives the packed bytes without setting up a board. Numbers are stored little endian whatever the machine
+
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include "board_and_players.h"
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+enum record_type { position_records = 1, game_records = 2 };
+const int records_per_block = 4096;		// The number of records in every block but the last
+const int max_stored_plies = 1024;		// The longest game that can be stored
+
+																																// PACKED_POSITION STRUCT
+struct packed_position {																										//--------------------------------------------------------------------------------------------------------
+	std::uint64_t occupancy;		// The occupied squares
+	std::uint8_t pieces[16];		// The piece code of each occupied square in bit index order, two to a byte with the first in the low 4 bits
+	std::uint8_t flags;				// Bit 0 is set if black is to move, bits 1-4 are the castling rights
+	std::int8_t en_passant_column;	// The en passant column or no_en_passant
+	std::uint16_t halfmove_clock;	// The moves since a pawn moved or a piece was taken
+	std::uint16_t fullmove_number;	// The number of the move being played
+	std::int16_t score;				// A score for the position in hundredths of a pawn from white's point of view (0 if it hasn't been analysed)
+};
+
+																																// STORED_GAME STRUCT
+struct stored_game {																											//--------------------------------------------------------------------------------------------------------
+	std::uint8_t outcome;					// The game_outcome of the game
+	bool has_start_position;				// Whether the game starts from start_position instead of the usual start
+	packed_position start_position;
+	int number_of_moves;
+	std::uint16_t moves[max_stored_plies];	// The moves, each packed with pack_move
+};
+
+packed_position pack_position(const board &chessboard, int score = 0);															// [1]  Function to pack the position of a board into 32 bytes
+bool unpack_position(const packed_position &packed, position &p);																// [2]  Function to unpack the pieces of a packed position into bitboards, without a board, returns false if a code isn't a piece
+bool unpack_position(const packed_position &packed, board &chessboard);															// [3]  Function to set up a board from a packed position, returns false if it isn't a possible position
+
+																																// RECORD_WRITER CLASS
+class record_writer {																											//--------------------------------------------------------------------------------------------------------
+private:
+	std::ofstream file;
+	record_type type;
+	std::vector<std::uint8_t> block;		// The records of the block being written
+	int records_in_block;
+	std::uint64_t number_of_records;
+	std::vector<std::uint64_t> index;		// The file offset and first record number of every block written, two numbers for each block
+
+	void write_block();																											// [4]  Function to write the block being filled to the file
+public:
+	record_writer();																											// [5]  Unparameterised record_writer constructor
+	~record_writer();																											// [6]  Record_writer destructor, finishes the file if it is still open
+
+	bool open(const char *file_name, record_type type_of_records);																// [7]  Function to start a new file of one type of record, returns false if it can't be created
+	void write_position(const packed_position &packed);																			// [8]  Function to add a position to a file of positions
+	void write_game(const stored_game &game);																					// [9]  Function to add a game to a file of games
+	bool close();																												// [10] Function to write the last block, the index and the footer, returns false if anything couldn't be written
+	std::uint64_t records() const { return number_of_records; }																	// [11] Function to retrieve the number of records written
+};
+
+																																// RECORD_READER CLASS
+class record_reader {																											//--------------------------------------------------------------------------------------------------------
+private:
+	std::ifstream file;
+	record_type type;
+	std::vector<std::uint64_t> index;		// The file offset and first record number of every block, read from the end of the file
+	std::uint64_t number_of_records;
+	std::uint64_t index_offset;				// Where the index starts in the file, every block ends before it
+	std::vector<std::uint8_t> block;		// The records of the block being read
+	std::size_t block_offset;				// Where the next record starts in the block
+	int records_left_in_block;
+	std::size_t next_block;					// The index of the block to read when this one runs out
+
+	bool load_block(std::size_t block_number);																					// [12] Function to read a block of records from the file
+public:
+	record_reader();																											// [13] Unparameterised record_reader constructor
+
+	bool open(const char *file_name);																							// [14] Function to open a file and read its index, returns false if it isn't a file of records
+	record_type records_type() const { return type; }																			// [15] Function to retrieve the type of record in the file
+	std::uint64_t records() const { return number_of_records; }																	// [16] Function to retrieve the number of records in the file
+	std::size_t blocks() const { return index.size() / 2; }																		// [17] Function to retrieve the number of blocks in the file
+	bool seek(std::uint64_t record_number);																						// [18] Function to move to a record so that it is the next one read
+	bool read_position(packed_position &packed);																				// [19] Function to read the next position of a file of positions, returns false at the end of the file
+	bool read_game(stored_game &game);																							// [20] Function to read the next game of a file of games, returns false at the end of the file
+};
+
+int storage_main(int argc, char *argv[]);																						// [21] Function to print the records of a file from the command line arguments that follow "--read"
+
+#endif
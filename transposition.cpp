@@ -0,0 +1,119 @@
+// transposition.cpp implements the functions defined in the transposition.h header file
+
+#include "transposition.h"
+
+// TRANSPOSITION_TABLE CLASS
+//--------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// [1]  Function to pack an entry, its age and the top of its key into a data word. Bits 0-15 are the move, 16-31 the score, 32-39 the depth, 40-41 the
+//      bound, 42-47 the age and 48-63 the key fragment (the bucket already depends on the low bits of the key, so the top bits are the useful ones)
+
+std::uint64_t transposition_table::pack(std::uint64_t key, const tt_entry &entry, std::uint8_t entry_age)
+{
+	return std::uint64_t(pack_move(entry.move))
+		| (std::uint64_t(std::uint16_t(std::int16_t(entry.score))) << 16)
+		| (std::uint64_t(std::uint8_t(std::int8_t(entry.depth))) << 32)
+		| (std::uint64_t(entry.bound) << 40)
+		| (std::uint64_t(entry_age & 63) << 42)
+		| (key & 0xffff000000000000ULL);
+}
+
+// [2]  Function to unpack a data word into an entry
+
+tt_entry transposition_table::unpack(std::uint64_t data)
+{
+	tt_entry entry;
+	entry.move = unpack_move(std::uint16_t(data));
+	entry.score = std::int16_t(std::uint16_t(data >> 16));
+	entry.depth = std::int8_t(std::uint8_t(data >> 32));
+	entry.bound = score_bound((data >> 40) & 3);
+	return entry;
+}
+
+// [3]  Parameterised transposition_table constructor, the size is rounded down to a power of two buckets
+
+transposition_table::transposition_table(std::size_t megabytes) : bucket_mask{ 0 }, age{ 0 } { resize(megabytes); }
+
+// [4]  Function to change the size of the table to the largest power of two buckets that fits in the given megabytes (at least one bucket), which also
+//      empties it. This must not be called while a search is using the table
+
+void transposition_table::resize(std::size_t megabytes)
+{
+	std::size_t wanted = (megabytes << 20) / sizeof(bucket);
+	std::size_t number_of_buckets = 1;
+	while (number_of_buckets * 2 <= wanted) number_of_buckets *= 2;
+	buckets.reset(new bucket[number_of_buckets]);
+	bucket_mask = number_of_buckets - 1;
+	clear();
+}
+
+// [5]  Function to empty every entry, an entry whose check and data words are both 0 only matches the key 0 and has no bound, so it is never used
+
+void transposition_table::clear()
+{
+	for (std::uint64_t i = 0; i <= bucket_mask; i++) {
+		for (int slot = 0; slot < 4; slot++) {
+			buckets[i].check[slot].store(0, std::memory_order_relaxed);
+			buckets[i].data[slot].store(0, std::memory_order_relaxed);
+		}
+	}
+	age = 0;
+}
+
+// [7]  Function to look up a position, returns false if it isn't in the table. The words are read without a lock, the XOR check throws away an entry
+//      whose words came from two different writes
+
+bool transposition_table::probe(std::uint64_t key, tt_entry &entry) const
+{
+	const bucket &b = buckets[key & bucket_mask];
+	for (int slot = 0; slot < 4; slot++) {
+		std::uint64_t data = b.data[slot].load(std::memory_order_relaxed);
+		std::uint64_t check = b.check[slot].load(std::memory_order_relaxed);
+		if ((data ^ check) == key && (data & 0xffff000000000000ULL) == (key & 0xffff000000000000ULL)) {
+			entry = unpack(data);
+			return entry.bound != no_bound;
+		}
+	}
+	return false;
+}
+
+// [8]  Function to save the result of searching a position. An entry for the same position is always overwritten (keeping its move if the new result has
+//      none), otherwise the entry replaced is the one worth least: entries from older searches first, then the shallowest
+
+void transposition_table::store(std::uint64_t key, const tt_entry &entry)
+{
+	bucket &b = buckets[key & bucket_mask];
+	int replace = 0; int lowest_worth = 1 << 30;
+	tt_entry to_store = entry;
+	for (int slot = 0; slot < 4; slot++) {
+		std::uint64_t data = b.data[slot].load(std::memory_order_relaxed);
+		std::uint64_t check = b.check[slot].load(std::memory_order_relaxed);
+		if ((data ^ check) == key) { //the same position, keep the old move if there is no new one
+			if (pack_move(to_store.move) == 0) to_store.move = unpack_move(std::uint16_t(data));
+			replace = slot;
+			break;
+		}
+		int entry_age = int((data >> 42) & 63);
+		int age_difference = (age - entry_age) & 63;
+		int worth = int(std::int8_t(std::uint8_t(data >> 32))) - 8 * age_difference;
+		if (((data >> 40) & 3) == no_bound) worth = -(1 << 29); //empty slots are filled first
+		if (worth < lowest_worth) { lowest_worth = worth; replace = slot; }
+	}
+	std::uint64_t data = pack(key, to_store, age);
+	b.data[replace].store(data, std::memory_order_relaxed);
+	b.check[replace].store(key ^ data, std::memory_order_relaxed);
+}
+
+// [10] Function to estimate how full the table is in thousandths, by counting the entries of the current search in the first 250 buckets (1000 entries)
+
+int transposition_table::permille_full() const
+{
+	std::uint64_t sample = bucket_mask + 1 < 250 ? bucket_mask + 1 : 250;
+	int used = 0;
+	for (std::uint64_t i = 0; i < sample; i++) {
+		for (int slot = 0; slot < 4; slot++) {
+			std::uint64_t data = buckets[i].data[slot].load(std::memory_order_relaxed);
+			if (((data >> 40) & 3) != no_bound && ((data >> 42) & 63) == age) used++;
+		}
+	}
+	return int(used * 1000 / (sample * 4));
+}
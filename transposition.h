@@ -0,0 +1,55 @@
+// transposition.h declares the transposition_table class, a fixed size hash table of search results indexed by the Zobrist key of the position. The same
+// position is often reached by different orders of moves (transpositions), and once it has been searched the table gives back the score, depth and best
+// move so the search can skip it or at least search the best move first. The table is split into buckets of four entries, one 64 byte cache line each, and
+// the number of buckets is a power of two so the bucket of a key is found by masking its low bits. Each entry is two 64 bit words: a data word packing the
+// move, score, depth, bound, age and the top 16 bits of the key, and a check word holding the key XORed with the data. Many search threads read and write the table at the same time
+// without a lock, so two threads can write the two words of an entry at the same time and leave the words from different writes. A reader XORs the check
+// word with the data word and only trusts the entry if that gives back its key, which a torn entry almost never does
+
+#ifndef TRANSPOSITION_H
+#define TRANSPOSITION_H
+
+#include "chess_move.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+enum score_bound { no_bound = 0, upper_bound = 1, lower_bound = 2, exact_bound = 3 };		// What the stored score says about the real score: at most, at least or exactly
+
+																																// TT_ENTRY STRUCT
+struct tt_entry {																												//--------------------------------------------------------------------------------------------------------
+	chess_move move;		// The best move found, from and to are both 0 if there is none
+	int score;				// The score found, mate scores are relative to the position stored, not the root of the search
+	int depth;				// The depth the position was searched to
+	score_bound bound;		// Whether the score is an upper bound, a lower bound or exact
+};
+
+																																// TRANSPOSITION_TABLE CLASS
+class transposition_table {																										//--------------------------------------------------------------------------------------------------------
+private:
+	struct alignas(64) bucket {
+		std::atomic<std::uint64_t> check[4];	// The key XORed with the data of each entry
+		std::atomic<std::uint64_t> data[4];		// The move, score, depth, bound, age and key fragment of each entry packed into 64 bits
+	};
+	std::unique_ptr<bucket[]> buckets;
+	std::uint64_t bucket_mask;		// The number of buckets minus one
+	std::uint8_t age;				// Increased at the start of every search so entries from old searches are replaced first
+
+	static std::uint64_t pack(std::uint64_t key, const tt_entry &entry, std::uint8_t entry_age);								// [1]  Function to pack an entry, its age and the top of its key into a data word
+	static tt_entry unpack(std::uint64_t data);																					// [2]  Function to unpack a data word into an entry
+public:
+	transposition_table(std::size_t megabytes);																					// [3]  Parameterised transposition_table constructor, the size is rounded down to a power of two buckets
+	transposition_table(const transposition_table &) = delete;
+	transposition_table &operator=(const transposition_table &) = delete;
+
+	void resize(std::size_t megabytes);																							// [4]  Function to change the size of the table, which also empties it
+	void clear();																												// [5]  Function to empty every entry
+	void new_search() { age = (age + 1) & 63; }																					// [6]  Function to start a new search, so the entries of older searches are replaced first
+	bool probe(std::uint64_t key, tt_entry &entry) const;																		// [7]  Function to look up a position, returns false if it isn't in the table
+	void store(std::uint64_t key, const tt_entry &entry);																		// [8]  Function to save the result of searching a position
+	std::size_t size_in_bytes() const { return std::size_t(bucket_mask + 1) * sizeof(bucket); }									// [9]  Function to retrieve the memory used by the table
+	int permille_full() const;																									// [10] Function to estimate how full the table is in thousandths, from a sample of the buckets
+};
+
+#endif
@@ -0,0 +1,219 @@
+// uci.cpp implements the functions defined in the uci.h header file
+
+#include "uci.h"
+#include "piece_attacks.h"
+#include "search.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	const int default_hash_megabytes = 16;
+	const int max_hash_megabytes = 65536;
+	const int max_threads = 256;
+	const double move_overhead_seconds = 0.05;		// Time kept back from every move for the GUI and the pipes, so the engine never loses on time
+
+	// Everything the engine keeps between commands, shared by the command reader and the search thread
+	struct uci_session {
+		std::ostream &output;
+		std::mutex output_lock;						// Held while writing a line, so lines from the two threads never mix
+		board position_board;						// The position set up by the last "position" command
+		transposition_table table{ default_hash_megabytes };
+		int number_of_threads = 1;
+		std::unique_ptr<nnue_network> network;		// The network loaded with EvalFile, or nullptr to use the hand written evaluation
+		std::thread search_thread;
+		std::atomic<bool> stop_signal{ false };		// Set by "stop" or "quit", the search looks at it at every node
+		std::mutex stop_lock;						// With stop_changed, lets an infinite search wait for "stop" after it runs out of depth
+		std::condition_variable stop_changed;
+
+		explicit uci_session(std::ostream &out) : output{ out } {}
+	};
+
+	// Function to write one line of output under the lock and flush it, so the GUI sees it at once
+	void send(uci_session &session, const std::string &line)
+	{
+		std::lock_guard<std::mutex> lock(session.output_lock);
+		session.output << line << std::endl;
+	}
+
+	// Function to write a score the way UCI wants it, "cp" in hundredths of a pawn or "mate" in moves (negative if the engine is being mated)
+	std::string score_text(int score)
+	{
+		if (score >= mate_score - max_search_depth) return "mate " + std::to_string((mate_score - score + 1) / 2);
+		if (score <= -mate_score + max_search_depth) return "mate -" + std::to_string((mate_score + score + 1) / 2);
+		return "cp " + std::to_string(score);
+	}
+
+	// Function to stop the search if one is running and wait for its thread to finish (it sends its bestmove first)
+	void stop_search(uci_session &session)
+	{
+		{
+			std::lock_guard<std::mutex> lock(session.stop_lock);
+			session.stop_signal.store(true, std::memory_order_relaxed);
+		}
+		session.stop_changed.notify_all();
+		if (session.search_thread.joinable()) session.search_thread.join();
+	}
+
+	// Function to find the legal move of the board which a move in coordinate notation stands for, returns false if there is none
+	bool find_legal_move(const board &chessboard, const std::string &text, chess_move &m)
+	{
+		chess_move parsed;
+		if (parse_move_text(text, parsed) == false) return false;
+		move_list moves;
+		chessboard.generate_legal_moves(chessboard.team_to_move(), moves);
+		for (const chess_move &legal : moves) {
+			if (legal.from == parsed.from && legal.to == parsed.to && legal.promotion == parsed.promotion) { m = legal; return true; }
+		}
+		return false;
+	}
+
+	// Function to set up the position of a "position" command, the moves are made on the board one by one so it remembers the earlier positions of the
+	// game for finding repetitions. A FEN that can't be read leaves the start position and an illegal move ends the list, each is reported
+	void set_up_position(uci_session &session, std::istringstream &words)
+	{
+		std::string word, fen;
+		words >> word;
+		board chessboard;
+		if (word == "fen") {
+			while (words >> word && word != "moves") fen += (fen.empty() ? "" : " ") + word;
+			if (chessboard.from_fen(fen) == false) { send(session, "info string can't read the FEN " + fen); chessboard = board(); }
+		}
+		else words >> word; //"startpos" is the board as constructed, the next word should be "moves"
+		if (word == "moves") {
+			while (words >> word) {
+				chess_move m;
+				if (find_legal_move(chessboard, word, m) == false) { send(session, "info string illegal move " + word); break; }
+				chessboard.make_move(m);
+			}
+		}
+		session.position_board = chessboard;
+	}
+
+	// Function to set an engine option from a "setoption name <name> value <value>" command
+	void set_option(uci_session &session, std::istringstream &words)
+	{
+		std::string word, name, value;
+		words >> word; //"name"
+		while (words >> word && word != "value") name += (name.empty() ? "" : " ") + word;
+		while (words >> word) value += (value.empty() ? "" : " ") + word;
+
+		if (name == "Hash") {
+			int megabytes = std::clamp(std::atoi(value.c_str()), 1, max_hash_megabytes);
+			session.table.resize(std::size_t(megabytes));
+		}
+		else if (name == "Threads") session.number_of_threads = std::clamp(std::atoi(value.c_str()), 1, max_threads);
+		else if (name == "EvalFile") {
+			if (value.empty() || value == "<empty>") { session.network.reset(); return; }
+			std::unique_ptr<nnue_network> network = std::make_unique<nnue_network>();
+			if (network->load(value.c_str()) == false) { send(session, "info string can't read the weights file " + value); return; }
+			session.network = std::move(network);
+			send(session, "info string using the network in " + value);
+		}
+		else send(session, "info string no option called " + name);
+	}
+
+	// Function to start a search from a "go" command on the search thread. The time for the move is the given movetime, or else the team's remaining time
+	// shared over the moves still to play (30 if the GUI doesn't say) plus most of the increment, never more than the time left after the overhead
+	void start_search(uci_session &session, std::istringstream &words)
+	{
+		colour team_colour = session.position_board.team_to_move();
+		long long time_left[2] = { -1, -1 }, increment[2] = { 0, 0 }, move_time = -1, moves_to_go = 30;
+		search_limits limits;
+		bool infinite = false;
+		std::string word;
+		while (words >> word) {
+			long long number = 0;
+			if (word == "infinite") { infinite = true; continue; }
+			if (!(words >> number)) break;
+			if (word == "wtime") time_left[white] = number;
+			else if (word == "btime") time_left[black] = number;
+			else if (word == "winc") increment[white] = number;
+			else if (word == "binc") increment[black] = number;
+			else if (word == "movestogo" && number > 0) moves_to_go = number;
+			else if (word == "movetime") move_time = number;
+			else if (word == "nodes" && number > 0) limits.max_nodes = (unsigned long long)number;
+			else if (word == "depth" && number > 0) limits.max_depth = int(std::min<long long>(number, max_search_depth));
+		}
+		if (infinite == false) {
+			if (move_time >= 0) limits.max_seconds = std::max(move_time / 1000.0, 0.001);
+			else if (time_left[team_colour] >= 0) {
+				double remaining = time_left[team_colour] / 1000.0;
+				double budget = remaining / double(moves_to_go) + increment[team_colour] / 1000.0 * 0.75;
+				limits.max_seconds = std::max(std::min(budget, remaining - move_overhead_seconds), 0.001);
+			}
+		}
+
+		session.stop_signal.store(false, std::memory_order_relaxed);
+		session.search_thread = std::thread([&session, limits, infinite]() {
+			board chessboard = session.position_board;
+			auto start = std::chrono::steady_clock::now();
+			auto report = [&session, start](const search_result &r) {
+				long long milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+				std::string line = "info depth " + std::to_string(r.depth) + " score " + score_text(r.score) + " nodes " + std::to_string(r.nodes)
+					+ " nps " + std::to_string((unsigned long long)r.nodes_per_second()) + " time " + std::to_string(milliseconds)
+					+ " hashfull " + std::to_string(session.table.permille_full()) + " pv";
+				for (int ply = 0; ply < r.pv_length; ply++) line += " " + move_text(r.principal_variation[ply]);
+				send(session, line);
+			};
+			std::vector<unsigned long long> thread_nodes;
+			search_result result = parallel_search(chessboard, chessboard.team_to_move(), limits, session.table, session.number_of_threads, thread_nodes,
+				report, session.network.get(), &session.stop_signal);
+
+			if (infinite == true) { //the GUI expects no bestmove from an infinite search until it says stop, even if the search has finished
+				std::unique_lock<std::mutex> lock(session.stop_lock);
+				session.stop_changed.wait(lock, [&session]() { return session.stop_signal.load(std::memory_order_relaxed); });
+			}
+			send(session, "bestmove " + (result.best_move.from == result.best_move.to ? std::string("0000") : move_text(result.best_move)));
+		});
+	}
+}
+
+// [1]  Function to answer UCI commands from the input until "quit" or the end of the input, see uci.h for the commands. Unknown commands are ignored as the
+//      protocol asks
+
+int run_uci(std::istream &input, std::ostream &output)
+{
+	uci_session session(output);
+	std::string line;
+	while (std::getline(input, line)) {
+		std::istringstream words(line);
+		std::string command;
+		if (!(words >> command)) continue;
+
+		if (command == "uci") {
+			send(session, "id name Chess project");
+			send(session, "id author Owen Raymond");
+			send(session, "option name Hash type spin default " + std::to_string(default_hash_megabytes) + " min 1 max " + std::to_string(max_hash_megabytes));
+			send(session, "option name Threads type spin default 1 min 1 max " + std::to_string(max_threads));
+			send(session, "option name EvalFile type string default <empty>");
+			send(session, "uciok");
+		}
+		else if (command == "isready") send(session, "readyok");
+		else if (command == "stop") stop_search(session);
+		else if (command == "quit") break;
+		else if (command == "ucinewgame") { stop_search(session); session.table.clear(); }
+		else if (command == "position") { stop_search(session); set_up_position(session, words); }
+		else if (command == "setoption") { stop_search(session); set_option(session, words); }
+		else if (command == "go") { stop_search(session); start_search(session, words); }
+	}
+	stop_search(session);
+	return 0;
+}
+
+// [2]  Function to run the UCI mode from the command line arguments that follow "--uci", there are none so it just answers standard input
+
+int uci_main(int argc, char *argv[])
+{
+	(void)argc; (void)argv;
+	return run_uci(std::cin, std::cout);
+}
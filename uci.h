@@ -0,0 +1,28 @@
+// uci.h declares the UCI (Universal Chess Interface) mode of the chess executable, which lets the engine be run by a chess GUI or a tournament runner
+// instead of playing two people on the console. Commands are read one line at a time from the input and answers are written to the output:
+//
+//	uci											names the engine and lists its options, answered by "uciok"
+//	isready										answered by "readyok" straight away, even while a search is running
+//	setoption name Hash value <MB>				sets the size of the transposition table (and empties it)
+//	setoption name Threads value <N>			sets the number of search threads
+//	setoption name EvalFile value <file>		scores positions with the neural network in the file (see nnue.h), or the hand written evaluation if empty
+//	ucinewgame									empties the transposition table
+//	position [startpos | fen <FEN>] [moves ...]	sets up the position to search, the moves are in coordinate notation (e.g. "e2e4", "e7e8q")
+//	go [wtime T] [btime T] [winc T] [binc T] [movestogo N] [movetime T] [nodes N] [depth N] [infinite]
+//												starts a search (times in milliseconds), answered by "info" lines after each depth and then "bestmove"
+//	stop										stops the search, which answers with its "bestmove" straight away
+//	quit										stops any search and leaves
+//
+// The search runs on its own thread while the command reader carries on reading, so "stop" and "isready" are answered during a search. The searching
+// threads look at the stop flag at every node, so a stop takes effect within microseconds. Both threads write to the output under one lock, so their
+// lines never mix. A command that changes the engine's state ("position", "setoption", "ucinewgame" or another "go") stops any search still running
+
+#ifndef UCI_H
+#define UCI_H
+
+#include <iosfwd>
+
+int run_uci(std::istream &input, std::ostream &output);																			// [1]  Function to answer UCI commands from the input until "quit" or the end of the input
+int uci_main(int argc, char *argv[]);																							// [2]  Function to run the UCI mode from the command line arguments that follow "--uci"
+
+#endif
@@ -0,0 +1,21 @@
+// zobrist.cpp implements the functions defined in the zobrist.h header file
+
+#include "zobrist.h"
+
+// [5]  Function to work out the key of a position from scratch by XORing together the numbers of everything in it. The board only does this to check its
+//      incrementally updated key, every move updates the key without calling this
+
+std::uint64_t position_key(const position &p, colour side_to_move, std::uint8_t castling_rights, std::int8_t en_passant_column)
+{
+	std::uint64_t key = 0;
+	for (int team = 0; team < 2; team++) {
+		for (int type = 0; type < number_of_piece_types; type++) {
+			bitboard pieces = p.piece_sets[team][type];
+			while (pieces) key ^= piece_key(colour(team), piece_index(type), pop_lowest_square(pieces));
+		}
+	}
+	key ^= zobrist_keys.castling[castling_rights];
+	key ^= en_passant_key(en_passant_column);
+	if (side_to_move == black) key ^= zobrist_keys.black_to_move;
+	return key;
+}
@@ -0,0 +1,52 @@
+// zobrist.h declares the Zobrist keys used to give every position a 64 bit identity. Each piece on each square, the side to move, each castling right and
+// each en passant column has its own random number and the key of a position is all of its numbers XORed together. Since XOR undoes itself, a move changes
+// the key by XORing out what it takes away and XORing in what it adds, so the board keeps its key up to date in a few instructions per move instead of
+// working it out from every piece. The random numbers come from a fixed seed and are made when the program is compiled, so a position has the same key in
+// every run of the program (which matters for anything saved to a file)
+
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include "bitboard.h"
+#include <cstdint>
+
+																																// ZOBRIST_TABLE STRUCT
+struct zobrist_table {																											//--------------------------------------------------------------------------------------------------------
+	std::uint64_t pieces[2][number_of_piece_types][64];	// One number for each piece of each team on each square, indexed by [colour][piece_index][bit index]
+	std::uint64_t castling[16];							// One number for each set of castling rights, the XOR of the numbers of the rights in the set
+	std::uint64_t en_passant[8];						// One number for each column a pawn can be taken en passant on
+	std::uint64_t black_to_move;						// XORed into the key when it is black's turn
+};
+
+constexpr std::uint64_t next_random(std::uint64_t &state) {																		// [1]  Function to make the next number of the SplitMix64 random sequence
+	std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+constexpr zobrist_table make_zobrist_table(std::uint64_t seed) {																// [2]  Function to fill in every number of the table from a seed when the program is compiled
+	zobrist_table table{};
+	for (int team = 0; team < 2; team++) {
+		for (int type = 0; type < number_of_piece_types; type++) {
+			for (int index = 0; index < 64; index++) table.pieces[team][type][index] = next_random(seed);
+		}
+	}
+	std::uint64_t rights[4] = { next_random(seed), next_random(seed), next_random(seed), next_random(seed) };
+	for (int set = 0; set < 16; set++) {
+		for (int right = 0; right < 4; right++) {
+			if (set & (1 << right)) table.castling[set] ^= rights[right];
+		}
+	}
+	for (int column = 0; column < 8; column++) table.en_passant[column] = next_random(seed);
+	table.black_to_move = next_random(seed);
+	return table;
+}
+
+inline constexpr zobrist_table zobrist_keys = make_zobrist_table(0x43686573734b6579ULL);
+
+inline std::uint64_t piece_key(colour piece_colour, piece_index type_index, int index) { return zobrist_keys.pieces[piece_colour][type_index][index]; }	// [3]  Function to find the number of a piece on a square
+inline std::uint64_t en_passant_key(std::int8_t en_passant_column) { return en_passant_column == no_en_passant ? 0 : zobrist_keys.en_passant[en_passant_column]; }	// [4]  Function to find the number of an en passant column, or 0 if there is none
+std::uint64_t position_key(const position &p, colour side_to_move, std::uint8_t castling_rights, std::int8_t en_passant_column);	// [5]  Function to work out the key of a position from scratch
+
+#endif